@@ -14,191 +14,603 @@
 int PORT = 80;
 const char *GOOGLE = "google.com";
 
-const String CLIENT_TYPE_PARAM="&client=arduino";
-const String APP_SPOT_DOMAIN = ".appspot.com";
-const String PROTOCAL = "HTTP/1.1";
-
-const int WAIT_TIME = 1000;
-
-Nimbits::Nimbits(String instance, String ownerEmail, String accessKey){
-_instance = instance;
-_ownerEmail = ownerEmail;
-_accessKey = accessKey;
-
-}
-
-void Nimbits::createPoint(String pointName) {
-     EthernetClient client;
-                       if (client.connect(GOOGLE, PORT)) {
-                         client.println("POST /service/point HTTP/1.1");
-                         String content;
-                       //  writeAuthParams(content);
-                          content += "email=";
-                          content += _ownerEmail;
-                          if (_accessKey.length() > 0) {
-                                 content += ("&key=");
-                                 content += (_accessKey);
-                          }
-                         content += ("&action=create");
-                         content += ("&point=");
-                         content += (pointName);
-                          client.println("Host:nimbits1.appspot.com");
-                          client.println("Connection:close");
-                          client.println("Cache-Control:max-age=0");
-                          client.print("Content-Type: application/x-www-form-urlencoded\n");
-                          client.print("Content-Length: ");
-                          client.print(content.length());
-                          client.print("\n\n");
-                          client.print(content);
-                           while(client.connected() && !client.available()) delay(1); //waits for data
-                           client.stop();
-                           client.flush();
-                       }
-
-
-
-}
-
-String Nimbits::recordValue(String point, float value) {
-     EthernetClient client;
-                       if (client.connect(GOOGLE, PORT)) {
-                         client.println("POST /service/value HTTP/1.1");
-                         String content;
-                       //  writeAuthParams(content);
-                          content += "email=";
-                          content += _ownerEmail;
-                          if (_accessKey.length() > 0) {
-                                 content += ("&key=");
-                                 content += (_accessKey);
-                          }
-
-                           char buffer[10];
-
-                           dtostrf(value,5,5,buffer);
-                           String str = buffer;
-
-
-                          content += ("&value=");
-                          content += (str);
-                          content += ("&point=");
-                          content += (point);
-                          client.println("Host:nimbits1.appspot.com");
-                          client.println("Connection:close");
-                          client.println("Cache-Control:max-age=0");
-                          client.print("Content-Type: application/x-www-form-urlencoded\n");
-                          client.print("Content-Length: ");
-                          client.print(content.length());
-                          client.print("\n\n");
-                          client.print(content);
-                           while(client.connected() && !client.available()) delay(1); //waits for data
-                           client.stop();
-                           client.flush();
-                              return content;
-                       }
+#define CLIENT_TYPE_PARAM "&client=arduino"
+#define APP_SPOT_DOMAIN ".appspot.com"
+#define PROTOCAL "HTTP/1.1"
+
+NimbitsWriter::NimbitsWriter(Client *client, uint8_t *buffer, size_t size) {
+    _client = client;
+    _buffer = buffer;
+    _size = size < NIMBITS_MSS ? size : NIMBITS_MSS;
+    _fill = 0;
+    _length = 0;
+    _failed = false;
+}
+
+size_t NimbitsWriter::write(uint8_t c) {
+    _length++;
+    if (_client) {
+        if (_size == 0) {
+            if (_client->write(c) != 1)
+                _failed = true;
+            return 1;
+        }
+        _buffer[_fill++] = c;
+        if (_fill == _size)
+            flush();
+    }
+    return 1;
+}
+
+size_t NimbitsWriter::write(const uint8_t *data, size_t length) {
+    size_t n;
+    for (n = 0; n < length; n++)
+        write(data[n]);
+    return length;
+}
+
+// Returns false if any part of the output was refused by the client.
+bool NimbitsWriter::flush() {
+    if (_client && _fill > 0 && _client->write(_buffer, _fill) != _fill)
+        _failed = true;
+    _fill = 0;
+    return !_failed;
+}
+
+// A string that doesn't fit is not cut but left empty, false.
+static bool copy(char *to, const char *from, size_t size) {
+    if (strlen(from) >= size) {
+        to[0] = 0;
+        return false;
+    }
+    strcpy(to, from);
+    return true;
+}
+
+Nimbits::Nimbits(const char *instance, const char *ownerEmail, const char *accessKey) {
+    begin(instance, ownerEmail, accessKey);
+}
+
+Nimbits::Nimbits(const String &instance, const String &ownerEmail, const String &accessKey) {
+    begin(instance.c_str(), ownerEmail.c_str(), accessKey.c_str());
+}
+
+void Nimbits::begin(const char *instance, const char *ownerEmail, const char *accessKey) {
+    _valid = copy(_instance, instance, sizeof _instance);
+    _valid &= copy(_ownerEmail, ownerEmail, sizeof _ownerEmail);
+    _valid &= copy(_accessKey, accessKey, sizeof _accessKey);
+    setBuffer(_send, sizeof _send);
+    for (uint8_t i = 0; i < NIMBITS_REQUESTS; i++)
+        _requests[i].state = REQUEST_FREE;
+    memset(&_stats, 0, sizeof _stats);
+    memset(_cache, 0, sizeof _cache);
+    _known = false;
+}
 
+// A buffer as large as the longest request sends each request in one write,
+// the 64 byte default needs about 4 for a value POST.
+void Nimbits::setBuffer(uint8_t *buffer, size_t size) {
+    _buffer = buffer;
+    _bufferSize = size;
+}
+
+void Nimbits::createPoint(const char *pointName) {
+    Request *r = claim();
+    Point point = { pointName, 0 };
 
+    if (post(*r, "/service/point", FORM_CREATE, &point, 1))
+        wait(*r);
+}
+
+void Nimbits::createPoint(const String &pointName) {
+    createPoint(pointName.c_str());
+}
 
+bool Nimbits::postValue(const char *pointName, float value) {
+    Request *r = claim();
+    Point point = { pointName, value };
 
+    invalidate(pointName);
+    return post(*r, "/service/value", FORM_VALUE, &point, 1) && wait(*r) == NIMBITS_OK;
+}
+
+// Collects printed text, for the result of recordValue().
+class NimbitsText : public Print {
+  public:
+    String text;
+    virtual size_t write(uint8_t c) { text += (char)c; return 1; }
+    using Print::write;
+};
+
+// As before the form body that was posted, empty if it was not sent.
+// postValue() does the same without a String.
+String Nimbits::recordValue(String pointName, float value) {
+    NimbitsText form;
+    Point point = { pointName.c_str(), value };
+
+    if (!postValue(point.name, value))
+        return String();
+    writeForm(form, FORM_VALUE, &point, 1);
+    return form.text;
+}
+
+// All values go out in one request (p1=..&v1=..&p2=..), one connection
+// per batch instead of one per point.
+bool Nimbits::recordValues(const Point *points, size_t count) {
+    Request *r;
+    size_t i;
+
+    if (count == 0)
+        return true;
+    for (i = 0; i < count; i++)
+        invalidate(points[i].name);
+    r = claim();
+    return post(*r, "/service/batch", FORM_BATCH, points, count) && wait(*r) == NIMBITS_OK;
 }
 
 long Nimbits::getTime() {
-    EthernetClient client;
+    Request *r = claim();
 
-                      if (client.connect(GOOGLE, PORT)) {
-                        client.print("GET /service/time?");
-                        writeAuthParamsToClient(client);
-                        writeHostToClient(client);
+    if (!get(*r, "/service/time?", 0) || wait(*r) != NIMBITS_OK)
+        return -1;
+    return atol(r->data);
+}
 
-                         String response = getResponse(client);
-                         return atol(&response[0]);
+float Nimbits::getValue(const char *pointName) {
+    Entry *e = find(pointName);
+    Request *r;
+    unsigned long age;
+
+    if (e && e->valid) {
+        age = millis() - e->fetched;
+        if (age < e->ttl) {
+            _stats.hits++;
+            return e->value;
+        }
+        if (age - e->ttl < e->stale) {
+            _stats.hits++;
+            _stats.stale++;
+            if (!e->request && (r = slot()) && get(*r, "/service/value?", pointName))
+                refresh(*r, e);
+            return e->value;
+        }
+    }
+    if (e)
+        _stats.misses++;
+    r = claim();
+    if (!get(*r, "/service/value?", pointName))
+        return -1;
+    if (e)
+        refresh(*r, e);
+    if (wait(*r) != NIMBITS_OK)
+        return -1;
+    return atof(r->data);
+}
 
-                      }
-                      else {
-                      return -1;
+float Nimbits::getValue(const String &pointName) {
+    return getValue(pointName.c_str());
+}
 
-                      }
- }
+int8_t Nimbits::getValueAsync(const char *pointName, NimbitsCallback done, unsigned long timeout) {
+    Request *r = slot();
+    Entry *e = find(pointName);
+    bool sent = r && get(*r, "/service/value?", pointName);
 
-float Nimbits::getValue(String pointName) {
+    if (sent && e)
+        refresh(*r, e);
+    return queue(r, sent, done, timeout);
+}
 
+int8_t Nimbits::getTimeAsync(NimbitsCallback done, unsigned long timeout) {
+    Request *r = slot();
 
-                  EthernetClient client;
+    return queue(r, r && get(*r, "/service/time?", 0), done, timeout);
+}
 
-                  if (client.connect(GOOGLE, PORT)) {
-                    client.print("GET /service/value?");
-                    writeAuthParamsToClient(client);
-                    client.print("&point=");
-                    client.print(pointName);
-                    writeHostToClient(client);
+int8_t Nimbits::recordValueAsync(const char *pointName, float value, NimbitsCallback done, unsigned long timeout) {
+    Request *r = slot();
+    Point point = { pointName, value };
 
-                     return atof(&getResponse(client)[0]);
+    invalidate(pointName);
+    return queue(r, r && post(*r, "/service/value", FORM_VALUE, &point, 1), done, timeout);
+}
 
-                  }
-                  else {
-                  return -1;
+// The points are written out before this returns, they need not be kept.
+int8_t Nimbits::recordValuesAsync(const Point *points, size_t count, NimbitsCallback done, unsigned long timeout) {
+    Request *r = slot();
+    size_t i;
 
-                  }
+    for (i = 0; i < count; i++)
+        invalidate(points[i].name);
+    return queue(r, r && count && post(*r, "/service/batch", FORM_BATCH, points, count), done, timeout);
+}
 
-                }
+bool Nimbits::cache(const char *pointName, unsigned long ttl, unsigned long stale) {
+    Entry *e = find(pointName);
+    uint8_t i;
+
+    if (strlen(pointName) >= NIMBITS_POINT_SIZE)
+        return false;
+    for (i = 0; !e && i < NIMBITS_CACHE_SIZE; i++)
+        if (!_cache[i].name[0])
+            e = &_cache[i];
+    if (!e)
+        return false;
+    strcpy(e->name, pointName);
+    e->ttl = ttl;
+    e->stale = stale;
+    e->valid = false;
+    e->request = 0;
+    return true;
+}
 
-String Nimbits::getResponse(EthernetClient client) {
-   String result;
-   boolean inData = false;
-   char c;
-   while(client.connected() && !client.available()) delay(1);
-                       while (client.available()) {
-                         c = client.read();
-                         if (c == '|') inData = true;
-                         else if (inData && c != '|') result += c;
-                         else if (inData && c == '|') client.stop();
-                       }
+// Also drops a refresh in flight, its value may predate the write.
+void Nimbits::invalidate(const char *pointName) {
+    Entry *e = find(pointName);
 
-   return result;
+    if (e) {
+        e->valid = false;
+        e->request = 0;
+    }
 }
 
-void  Nimbits::writeHostToClient(EthernetClient client) {
-      client.print(CLIENT_TYPE_PARAM);
-      client.print(" ");
-      client.println(PROTOCAL);
-      client.print("Host:");
-                         client.print(_instance);
-                         client.println(APP_SPOT_DOMAIN);
-                         client.println();
+Nimbits::Entry *Nimbits::find(const char *pointName) {
+    for (uint8_t i = 0; i < NIMBITS_CACHE_SIZE; i++)
+        if (_cache[i].name[0] && strcmp(_cache[i].name, pointName) == 0)
+            return &_cache[i];
+    return 0;
 }
 
-void Nimbits::writeAuthParamsToClient(EthernetClient client) {
-     client.print("email=");
-     client.print(_ownerEmail);
-     if (_accessKey.length() > 0) {
-        client.print("&key=");
-        client.print(_accessKey);
-     }
+// The reply to request 'r' goes into cache entry 'e' (see finish()).
+void Nimbits::refresh(Request &r, Entry *e) {
+    r.refresh = e - _cache + 1;
+    e->request = &r - _requests + 1;
 }
 
-String Nimbits::writeAuthParams(String content) {
-     content += "email=";
-      content += (_ownerEmail);
-     if (_accessKey.length() > 0) {
-        content += ("&key=");
-        content += (_accessKey);
-     }
+// Advances every request in flight, call it from loop().
+void Nimbits::poll() {
+    for (uint8_t i = 0; i < NIMBITS_REQUESTS; i++)
+        if (_requests[i].state != REQUEST_FREE)
+            advance(_requests[i]);
 }
 
-//record a value
+uint8_t Nimbits::pending() const {
+    uint8_t i, n = 0;
 
-//record data
+    for (i = 0; i < NIMBITS_REQUESTS; i++)
+        if (_requests[i].state != REQUEST_FREE)
+            n++;
+    return n;
+}
 
-//create point
+void Nimbits::close() {
+    for (uint8_t i = 0; i < NIMBITS_REQUESTS; i++)
+        if (_requests[i].state == REQUEST_FREE)
+            _requests[i].client.stop();
+}
 
-//create point with parent
+// A free slot, preferably one that still holds an open connection.
+Nimbits::Request *Nimbits::slot() {
+    Request *free = 0;
+
+    for (uint8_t i = 0; i < NIMBITS_REQUESTS; i++)
+        if (_requests[i].state == REQUEST_FREE) {
+            if (_requests[i].client.connected())
+                return &_requests[i];
+            if (!free)
+                free = &_requests[i];
+        }
+    return free;
+}
 
-//batch update
+// A slot for a blocking call, waits for a request in flight if all are busy.
+Nimbits::Request *Nimbits::claim() {
+    Request *r;
 
-//delete point
+    while (!(r = slot())) {
+        poll();
+        delay(1);
+    }
+    return r;
+}
 
-//get children with values
+int8_t Nimbits::queue(Request *r, bool sent, NimbitsCallback done, unsigned long timeout) {
+    if (!sent)
+        return -1;
+    r->done = done;
+    r->timeout = timeout;
+    return r - _requests;
+}
+
+// Looks up the server once per NIMBITS_DNS_TTL instead of on every connect.
+bool Nimbits::resolve() {
+    DNSClient dns;
+
+    if (_known && millis() - _resolved < NIMBITS_DNS_TTL)
+        return true;
+    dns.begin(Ethernet.dnsServerIP());
+    _stats.lookups++;
+    _known = dns.getHostByName(GOOGLE, _address) == 1;
+    _resolved = millis();
+    return _known;
+}
+
+// Makes sure the request has a connection. Returns 0 on failure, 1 for a
+// new connection and 2 when the kept one is still open.
+uint8_t Nimbits::connect(Request &r) {
+    if (!_valid)
+        return 0;                            // see valid()
+    if (r.client.connected()) {
+        _stats.reused++;
+        return 2;
+    }
+    r.client.stop();
+    if (!resolve())
+        return 0;
+    if (!r.client.connect(_address, PORT)) {
+        _known = false;                      // the address may have moved
+        return 0;
+    }
+    _stats.connects++;
+    return 1;
+}
+
+void Nimbits::open(Request &r) {
+    r.done = 0;
+    r.start = millis();
+    r.timeout = NIMBITS_TIMEOUT;
+    r.remaining = -1;
+    r.state = REQUEST_STATUS;
+    r.field = FIELD_NAME;
+    r.pipes = 0;
+    r.keep = true;
+    r.refresh = 0;
+    r.status = NIMBITS_OK;
+    r.length = 0;
+}
 
+// Takes what has arrived for the request and checks its deadline.
+// Returns true once the request is finished.
+bool Nimbits::advance(Request &r) {
+    char c;
+
+    while (r.state != REQUEST_FREE && r.client.available()) {
+        c = r.client.read();
+        if (r.state == REQUEST_BODY)
+            body(r, c);
+        else
+            header(r, c);
+    }
+    if (r.state == REQUEST_FREE)
+        return true;
+    if (!r.client.connected()) {
+        r.keep = false;
+        finish(r, r.state == REQUEST_BODY && (r.remaining < 0 || r.pipes) ? NIMBITS_OK : NIMBITS_CLOSED);
+    }
+    else if (millis() - r.start >= r.timeout) {
+        r.keep = false;
+        finish(r, NIMBITS_EXPIRED);
+    }
+    return r.state == REQUEST_FREE;
+}
+
+// Header names are compared as far as they fit into Request::data.
+static bool named(const char *data, const char *name) {
+    return strncmp(data, name, NIMBITS_VALUE_SIZE - 1) == 0;
+}
+
+// Reply head, one byte at a time. Only what decides whether the connection
+// can be kept is looked at: the version, Content-Length, Connection and
+// Transfer-Encoding.
+void Nimbits::header(Request &r, char c) {
+    if (c == '\r')
+        return;
+    if (c == '\n') {
+        r.data[r.length] = 0;
+        if (r.state == REQUEST_STATUS) {
+            if (strncmp(r.data, "http/1.0", 8) == 0)
+                r.keep = false;
+            if (strncmp(r.data, "http/", 5) != 0 || r.data[8] != '2')
+                r.status = NIMBITS_REFUSED;  // "http/1.1200ok", spaces are skipped
+            r.state = REQUEST_HEADER;
+        }
+        else if (r.field == FIELD_NAME && r.length == 0) {
+            r.state = REQUEST_BODY;          // blank line, the body follows
+            if (r.remaining == 0)
+                finish(r, NIMBITS_OK);
+        }
+        else if (r.field == FIELD_CONNECTION && strcmp(r.data, "close") == 0)
+            r.keep = false;
+        else if (r.field == FIELD_TRANSFER && strcmp(r.data, "chunked") == 0) {
+            r.remaining = -1;                // read up to the value and close
+            r.keep = false;
+        }
+        r.field = FIELD_NAME;
+        r.length = 0;
+        return;
+    }
+    if (r.field == FIELD_NAME && c == ':' && r.state == REQUEST_HEADER) {
+        r.data[r.length] = 0;
+        if (named(r.data, "content-length")) {
+            r.field = FIELD_LENGTH;
+            r.remaining = 0;
+        }
+        else if (named(r.data, "connection"))
+            r.field = FIELD_CONNECTION;
+        else if (named(r.data, "transfer-encoding"))
+            r.field = FIELD_TRANSFER;
+        else
+            r.field = FIELD_OTHER;
+        r.length = 0;
+    }
+    else if (r.field == FIELD_LENGTH) {
+        if (c >= '0' && c <= '9')
+            r.remaining = r.remaining * 10 + c - '0';
+    }
+    else if (r.field != FIELD_OTHER && c != ' ' && r.length < NIMBITS_VALUE_SIZE - 1)
+        r.data[r.length++] = tolower(c);
+}
 
+// Reply body: the value is the text between the first two '|'.
+void Nimbits::body(Request &r, char c) {
+    if (c == '|')
+        r.pipes++;
+    else if (r.pipes == 1 && r.length < NIMBITS_VALUE_SIZE - 1)
+        r.data[r.length++] = c;
+    if (r.remaining > 0 && --r.remaining == 0)
+        finish(r, NIMBITS_OK);
+    else if (r.remaining < 0 && r.pipes == 2) {
+        r.keep = false;                      // the rest cannot be skipped
+        finish(r, NIMBITS_OK);
+    }
+}
 
+// A request that completed on a connection the server keeps open leaves it
+// open for the next one. The body of a reply other than 2xx is no value.
+void Nimbits::finish(Request &r, uint8_t status) {
+    Entry *e;
+
+    if (status == NIMBITS_OK && r.status == NIMBITS_REFUSED)
+        status = NIMBITS_REFUSED;
+    if (!r.keep || status != NIMBITS_OK)
+        r.client.stop();
+    if (r.state != REQUEST_BODY || status != NIMBITS_OK)
+        r.length = 0;
+    r.data[r.length] = 0;
+    r.state = REQUEST_FREE;
+    r.status = status;
+    if (r.refresh) {
+        e = &_cache[r.refresh - 1];
+        if (e->request == &r - _requests + 1) {
+            if (status == NIMBITS_OK) {
+                e->value = atof(r.data);
+                e->fetched = millis();
+                e->valid = true;
+            }
+            e->request = 0;
+        }
+        r.refresh = 0;
+    }
+    if (r.done)
+        r.done(&r - _requests, status, r.data);
+}
 
+// Blocking use of a request, bounded by its deadline.
+uint8_t Nimbits::wait(Request &r) {
+    while (!advance(r)) delay(1);
+    return r.status;
+}
+
+// Form body of a POST. It is written twice, once to count Content-Length
+// and once to the socket.
+void Nimbits::writeForm(Print &out, Form form, const Point *points, size_t count) {
+    size_t i;
+
+    writeAuthParamsToClient(out);
+    switch (form) {
+        case FORM_CREATE:
+            out.print(F("&action=create&point="));
+            out.print(points->name);
+            break;
+        case FORM_VALUE:
+            out.print(F("&value="));
+            out.print(points->value, 5);
+            out.print(F("&point="));
+            out.print(points->name);
+            break;
+        case FORM_BATCH:
+            for (i = 1; i <= count; i++, points++) {
+                out.print(F("&p"));
+                out.print((unsigned long)i);
+                out.print('=');
+                out.print(points->name);
+                out.print(F("&v"));
+                out.print((unsigned long)i);
+                out.print('=');
+                out.print(points->value, 5);
+            }
+            break;
+    }
+}
 
+// Sends the request. A kept connection the server has closed in the
+// meantime refuses the write; the request then goes out on a new one.
+bool Nimbits::post(Request &r, const char *path, Form form, const Point *points, size_t count) {
+    NimbitsWriter counter(0, 0, 0);
+    uint8_t how;
+    bool sent;
+
+    writeForm(counter, form, points, count);
+    do {
+        if (!(how = connect(r)))
+            return false;
+        NimbitsWriter out(&r.client, _buffer, _bufferSize);
+        out.print(F("POST "));
+        out.print(path);
+        out.print(F(" " PROTOCAL "\r\nHost:"));
+        out.print(_instance);
+        out.print(F(APP_SPOT_DOMAIN "\r\n"
+                    "Cache-Control:max-age=0\r\n"
+                    "Content-Type: application/x-www-form-urlencoded\r\n"
+                    "Content-Length: "));
+        out.print((unsigned long)counter.length());
+        out.print(F("\r\n\r\n"));
+        writeForm(out, form, points, count);
+        if (!(sent = out.flush()))
+            r.client.stop();
+    } while (!sent && how == 2);
+    if (sent)
+        open(r);
+    return sent;
+}
+
+bool Nimbits::get(Request &r, const char *path, const char *pointName) {
+    uint8_t how;
+    bool sent;
+
+    do {
+        if (!(how = connect(r)))
+            return false;
+        NimbitsWriter out(&r.client, _buffer, _bufferSize);
+        out.print(F("GET "));
+        out.print(path);
+        writeAuthParamsToClient(out);
+        if (pointName) {
+            out.print(F("&point="));
+            out.print(pointName);
+        }
+        writeHostToClient(out);
+        if (!(sent = out.flush()))
+            r.client.stop();
+    } while (!sent && how == 2);
+    if (sent)
+        open(r);
+    return sent;
+}
+
+void Nimbits::writeHostToClient(Print &out) {
+    out.print(F(CLIENT_TYPE_PARAM " " PROTOCAL "\r\nHost:"));
+    out.print(_instance);
+    out.print(F(APP_SPOT_DOMAIN "\r\n\r\n"));
+}
+
+void Nimbits::writeAuthParamsToClient(Print &out) {
+    out.print(F("email="));
+    out.print(_ownerEmail);
+    if (_accessKey[0]) {
+        out.print(F("&key="));
+        out.print(_accessKey);
+    }
+}
+
+//record a value
+
+//record data
+
+//create point
+
+//create point with parent
+
+//delete point
+
+//get children with values
@@ -3,6 +3,11 @@ Nimbits.h - Library for interacting with the Nimbits Cloud Platform
 Created By Benjamin Sautner, May 2012
 Released into the public domain.
 
+Requests are streamed through a fixed buffer, nothing is put on the heap.
+The buffer goes to the W5100 whenever it is full, so a request leaves in
+a few writes instead of one per print(): a value POST of about 250 bytes
+takes 4 with the 64 byte default. setBuffer() with a buffer as large as
+the request (at most NIMBITS_MSS) sends it in one segment.
 */
 
 
@@ -10,21 +15,192 @@ Released into the public domain.
 #define _Nimbits_h
 #include "Arduino.h"
 #include <EthernetClient.h>
+
+// room for the account strings, including the terminating zero; a longer
+// string is not cut, valid() is false and every request fails
+#ifndef NIMBITS_INSTANCE_SIZE
+#define NIMBITS_INSTANCE_SIZE 24
+#endif
+#ifndef NIMBITS_EMAIL_SIZE
+#define NIMBITS_EMAIL_SIZE 40
+#endif
+#ifndef NIMBITS_KEY_SIZE
+#define NIMBITS_KEY_SIZE 40
+#endif
+
+// built in send buffer, setBuffer() can hand over a larger one
+#ifndef NIMBITS_BUFFER_SIZE
+#define NIMBITS_BUFFER_SIZE 64
+#endif
+
+// largest single write to the socket (TCP MSS on Ethernet)
+#define NIMBITS_MSS 1460
+
+// longest value text between the '|' of a reply
+#define NIMBITS_VALUE_SIZE 16
+
+// requests that can be in flight at once, each holds one W5100 socket
+#ifndef NIMBITS_REQUESTS
+#define NIMBITS_REQUESTS 2
+#endif
+
+// default time in ms a request may wait for its reply
+#ifndef NIMBITS_TIMEOUT
+#define NIMBITS_TIMEOUT 5000
+#endif
+
+// how long a looked up server address is used before it is looked up again
+#ifndef NIMBITS_DNS_TTL
+#define NIMBITS_DNS_TTL 3600000UL
+#endif
+
+// points getValue() can answer from memory, see Nimbits::cache()
+#ifndef NIMBITS_CACHE_SIZE
+#define NIMBITS_CACHE_SIZE 4
+#endif
+#ifndef NIMBITS_POINT_SIZE
+#define NIMBITS_POINT_SIZE 16
+#endif
+
+// status passed to a NimbitsCallback
+#define NIMBITS_OK      0
+#define NIMBITS_EXPIRED 1    // no reply before the deadline
+#define NIMBITS_CLOSED  2    // server closed without a value
+#define NIMBITS_REFUSED 3    // reply status other than 2xx
+
+// Called from poll() when request 'id' is finished. 'value' is the text
+// between the '|' of the reply (empty for posts), valid during the call.
+typedef void (*NimbitsCallback)(uint8_t id, uint8_t status, const char *value);
+
+// Collects printed bytes in a buffer and passes them to the client in
+// chunks. Without a client it only counts, which is how Content-Length
+// is found before the body is sent.
+class NimbitsWriter : public Print {
+  public:
+    NimbitsWriter(Client *client, uint8_t *buffer, size_t size);
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *data, size_t length);
+    using Print::write;
+    size_t length() const { return _length; }
+    bool flush();
+  private:
+    Client *_client;
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _fill;
+    size_t _length;
+    bool _failed;
+};
+
+// Connection counters, see Nimbits::stats().
+struct NimbitsStats {
+    unsigned long lookups;     // DNS queries
+    unsigned long connects;    // new TCP connections
+    unsigned long reused;      // requests sent on a kept connection
+    unsigned long hits;        // getValue() answered from the cache
+    unsigned long stale;       // ... with an expired value while it is refreshed
+    unsigned long misses;      // getValue() of a cached point that went remote
+};
+
 class Nimbits {
   public:
-    Nimbits(String instance, String ownerEmail, String accessKey);
-    float getValue(String pointName);
+    struct Point {
+        const char *name;
+        float value;
+    };
+    Nimbits(const char *instance, const char *ownerEmail, const char *accessKey);
+    Nimbits(const String &instance, const String &ownerEmail, const String &accessKey);
+    bool valid() const { return _valid; }  // the account strings fit
+    void setBuffer(uint8_t *buffer, size_t size);
+    float getValue(const char *pointName);
+    float getValue(const String &pointName);
     long getTime();
-    void createPoint(String pointName);
-    String recordValue(String pointName, float value);
+    void createPoint(const char *pointName);
+    void createPoint(const String &pointName);
+    String recordValue(String pointName, float value);    // returns the form posted
+    bool postValue(const char *pointName, float value);    // true when stored
+    bool recordValues(const Point *points, size_t count);
+
+    // Non-blocking variants: the request is sent and the reply is collected
+    // by poll(). They return the request id, -1 if no slot is free or the
+    // connection failed.
+    int8_t getValueAsync(const char *pointName, NimbitsCallback done, unsigned long timeout = NIMBITS_TIMEOUT);
+    int8_t getTimeAsync(NimbitsCallback done, unsigned long timeout = NIMBITS_TIMEOUT);
+    int8_t recordValueAsync(const char *pointName, float value, NimbitsCallback done = 0, unsigned long timeout = NIMBITS_TIMEOUT);
+    int8_t recordValuesAsync(const Point *points, size_t count, NimbitsCallback done = 0, unsigned long timeout = NIMBITS_TIMEOUT);
+    void poll();
+    uint8_t pending() const;
+
+    // getValue() of a cached point is answered from memory for 'ttl' ms.
+    // For 'stale' ms after that the old value is still returned while a
+    // refresh runs in the background (needs poll()). Writing the point
+    // through this object invalidates it.
+    bool cache(const char *pointName, unsigned long ttl, unsigned long stale = 0);
+    void invalidate(const char *pointName);
+
+    // Connections are kept open between requests; close() drops them.
+    void close();
+    const NimbitsStats &stats() const { return _stats; }
   private:
-    String _instance;
-    String _ownerEmail;
-    String _accessKey;
-    void writeHostToClient(EthernetClient client);
-    void writeAuthParamsToClient(EthernetClient client);
-    String getResponse(EthernetClient client);
-    String writeAuthParams(String content);
+    enum Form { FORM_CREATE, FORM_VALUE, FORM_BATCH };
+    enum State { REQUEST_FREE, REQUEST_STATUS, REQUEST_HEADER, REQUEST_BODY };
+    enum Field { FIELD_NAME, FIELD_OTHER, FIELD_LENGTH, FIELD_CONNECTION, FIELD_TRANSFER };
+    struct Request {
+        EthernetClient client;
+        NimbitsCallback done;
+        unsigned long start;
+        unsigned long timeout;
+        long remaining;            // body bytes still to come, -1 until close
+        uint8_t state;
+        uint8_t field;
+        uint8_t pipes;
+        bool keep;
+        uint8_t refresh;           // cache entry + 1 the value goes to
+        uint8_t status;
+        uint8_t length;
+        char data[NIMBITS_VALUE_SIZE];
+    };
+    struct Entry {
+        char name[NIMBITS_POINT_SIZE];
+        float value;
+        unsigned long fetched;
+        unsigned long ttl;
+        unsigned long stale;
+        bool valid;
+        uint8_t request;           // request slot + 1 refreshing it, 0 none
+    };
+    Request _requests[NIMBITS_REQUESTS];
+    Entry _cache[NIMBITS_CACHE_SIZE];
+    NimbitsStats _stats;
+    IPAddress _address;
+    unsigned long _resolved;
+    bool _known;
+    bool _valid;
+    char _instance[NIMBITS_INSTANCE_SIZE];
+    char _ownerEmail[NIMBITS_EMAIL_SIZE];
+    char _accessKey[NIMBITS_KEY_SIZE];
+    uint8_t _send[NIMBITS_BUFFER_SIZE];
+    uint8_t *_buffer;
+    size_t _bufferSize;
+    void begin(const char *instance, const char *ownerEmail, const char *accessKey);
+    Request *slot();
+    Request *claim();
+    int8_t queue(Request *r, bool sent, NimbitsCallback done, unsigned long timeout);
+    bool resolve();
+    uint8_t connect(Request &r);
+    bool post(Request &r, const char *path, Form form, const Point *points, size_t count);
+    bool get(Request &r, const char *path, const char *pointName);
+    void open(Request &r);
+    bool advance(Request &r);
+    void header(Request &r, char c);
+    void body(Request &r, char c);
+    void finish(Request &r, uint8_t status);
+    uint8_t wait(Request &r);
+    Entry *find(const char *pointName);
+    void refresh(Request &r, Entry *e);
+    void writeHostToClient(Print &out);
+    void writeAuthParamsToClient(Print &out);
+    void writeForm(Print &out, Form form, const Point *points, size_t count);
 };
 
 
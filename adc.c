@@ -0,0 +1,101 @@
+//******************************************************************************
+//  adc.c - Multi channel ADC12 sampling in one conversion sequence
+//
+//  Adc_Control[] lists the ADC12MCTLx setting of every channel. Adc_Start()
+//  programs ADC12MCTL0.. with ADC_SAMPLES consecutive entries per channel
+//  and starts the sequence. The ADC12 runs from its own oscillator (ADC12OSC),
+//  so it keeps converting in LPM3. The interrupt of the last slot sums up the
+//  results per channel, switches ADC12 and reference off and wakes the CPU.
+//  If ADC_CHANNELS doesn't divide 16, the last 16 % ADC_CHANNELS slots stay
+//  unused.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "adc.h"
+
+static const unsigned char Adc_Control[ADC_CHANNELS] = {
+  SREF_1 | INCH_10,                          // int. ref. (1,5 V), channel 10
+  SREF_0 | INCH_0                            // AVcc, channel 0 (NTC)
+};
+
+// 16 sequence slots, each channel gets at least one
+typedef char Adc_Channels_Check[ADC_CHANNELS >= 1 && ADC_CHANNELS <= 16 ? 1 : -1];
+
+static unsigned int Adc_Sum[ADC_CHANNELS];
+static volatile unsigned char Adc_Busy = 0;
+
+void Adc_Start(void)
+{
+  volatile unsigned char *mctl = &ADC12MCTL0;
+  unsigned char i;
+
+  ADC12CTL0 = ADC12ON | SHT0_15 | SHT1_15 | MSH | REFON;  // ADC on, int. ref. on (1,5 V),
+                                                          // multiple sample & conversion
+  ADC12CTL1 = ADC12SSEL_0 | ADC12DIV_7 | CSTARTADD_0 | CONSEQ_1 | SHP;  // ADC12OSC / 8
+
+  for (i = 0; i < ADC_SLOTS; i++)
+    mctl[i] = Adc_Control[i / ADC_SAMPLES];
+  mctl[ADC_SLOTS - 1] |= EOS;                // last seg.
+
+  Adc_Busy = 1;
+  ADC12IFG = 0;
+  ADC12IE = 1 << (ADC_SLOTS - 1);            // interrupt after last conversion
+  ADC12CTL0 |= ENC;                          // enable conversion
+  ADC12CTL0 |= ADC12SC;                      // sample & convert
+}
+
+unsigned char Adc_Done(void)
+{
+  return !Adc_Busy;
+}
+
+void Adc_Wait(void)
+{
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();
+  while (Adc_Busy)
+  {
+    _BIS_SR(LPM3_bits + GIE);                // Enter LPM3 w/ interrupt
+    __disable_interrupt();
+  }
+  __set_interrupt_state(state);
+}
+
+void Adc_Sample(void)
+{
+  Adc_Start();
+  Adc_Wait();
+}
+
+unsigned int Adc_GetSum(unsigned char channel)
+{
+  return Adc_Sum[channel];
+}
+
+unsigned int Adc_GetAverage(unsigned char channel)
+{
+  return Adc_Sum[channel] / ADC_SAMPLES;
+}
+
+#pragma vector=ADC12_VECTOR
+__interrupt void adc12_isr (void)
+{
+  volatile unsigned int *mem = &ADC12MEM0;
+  unsigned char i;
+
+  ADC12CTL0 &= ~ENC;                         // disable conversion
+  ADC12CTL0 = 0;                             // ADC and reference off
+
+  for (i = 0; i < ADC_CHANNELS; i++)
+    Adc_Sum[i] = 0;
+  for (i = 0; i < ADC_SLOTS; i++)            // sum up values, clears ADC12IFG
+    Adc_Sum[i / ADC_SAMPLES] += mem[i];
+
+  Adc_Busy = 0;
+  _BIC_SR_IRQ(LPM3_bits);                    // Clear LPM3 bits from 0(SR)
+}
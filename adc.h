@@ -0,0 +1,28 @@
+/*
+adc.h - Multi channel ADC12 sampling in one conversion sequence
+
+All channels are converted in one CONSEQ_1 sequence over the first
+ADC_SLOTS of ADC12MEM0..15, ADC_SAMPLES conversions per channel. The ADC12 interrupt sums up the
+results, so the CPU can stay in LPM3 during the conversion.
+
+*/
+
+#ifndef _adc_h
+#define _adc_h
+
+#define ADC_CH_INTERNAL 0                    // internal temperature diode, INCH_10
+#define ADC_CH_NTC      1                    // external NTC on P6.0, INCH_0
+#define ADC_CHANNELS    2                    // entries in Adc_Control[] (adc.c)
+
+#define ADC_SAMPLES (16 / ADC_CHANNELS)      // oversampling per channel
+#define ADC_SLOTS   (ADC_CHANNELS * ADC_SAMPLES) // ADC12MEMx in use, <= 16
+
+void Adc_Start(void);                        // start sequence and return
+unsigned char Adc_Done(void);                // sequence complete?
+void Adc_Wait(void);                         // sleep in LPM3 until complete, main loop only
+void Adc_Sample(void);                       // Adc_Start() + Adc_Wait(), not from an ISR
+
+unsigned int Adc_GetSum(unsigned char channel);      // sum of ADC_SAMPLES results
+unsigned int Adc_GetAverage(unsigned char channel);  // 12 bit average
+
+#endif /* _adc_h */
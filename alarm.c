@@ -0,0 +1,171 @@
+//******************************************************************************
+//  alarm.c - Tickless alarms and clock on Timer_A
+//
+//  Deadlines are compared as signed differences to the current tick, so the
+//  wrap of the 32 bit tick count after 12 days does not matter. An alarm
+//  that is less than ALARM_MIN ticks ahead is due at once. The counter may
+//  still pass CCR1 before it is written (a long interrupt, a flash write
+//  holding the CPU), so TAR is read again afterwards and a passed alarm
+//  raises CCIFG itself instead of waiting for the next round of TAR.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "event.h"
+#include "alarm.h"
+
+#define ALARM_MIN 4                          // ticks, ~1 ms
+
+typedef struct
+{
+  unsigned long At;                          // deadline in ticks
+  unsigned char Event;
+  unsigned char Active;
+} Alarm;
+
+static Alarm Alarms[ALARM_COUNT];
+static unsigned long Overflows;              // of TAR, high part of the clock
+unsigned long Alarm_Wakeups;
+
+// TAR runs from ACLK, asynchronous to MCLK; a read during a count can be
+// wrong, two equal reads are not.
+static unsigned int Alarm_Counter(void)
+{
+  unsigned int t;
+
+  do
+    t = TAR;
+  while (t != TAR);
+  return t;
+}
+
+// Overflows and TAR with interrupts disabled; an overflow the ISR has not
+// seen yet is counted here.
+static unsigned long Alarm_High(unsigned int *low)
+{
+  *low = Alarm_Counter();
+  if ((TACTL & TAIFG) && *low < 0x8000)
+    return Overflows + 1;
+  return Overflows;
+}
+
+void Alarm_Init(void)
+{
+  unsigned char i;
+
+  for (i = 0; i < ALARM_COUNT; i++)
+    Alarms[i].Active = 0;
+  Overflows = 0;
+  TACCTL1 = 0;
+  TACTL = TASSEL_1 + ID_3 + MC_2 + TACLR + TAIE;  // ACLK/8, continuous
+}
+
+unsigned long Alarm_Now(void)
+{
+  __istate_t state = __get_interrupt_state();
+  unsigned long high;
+  unsigned int low;
+
+  __disable_interrupt();
+  high = Alarm_High(&low);
+  __set_interrupt_state(state);
+  return (high << 16) | low;
+}
+
+unsigned long Alarm_Seconds(void)
+{
+  __istate_t state = __get_interrupt_state();
+  unsigned long high;
+  unsigned int low;
+
+  __disable_interrupt();
+  high = Alarm_High(&low);
+  __set_interrupt_state(state);
+  return (high << 4) | (low >> 12);          // 65536 ticks = 16 s
+}
+
+// Posts the events of all due alarms, returns their number
+static unsigned char Alarm_Expire(unsigned long now)
+{
+  unsigned char i, n = 0;
+
+  for (i = 0; i < ALARM_COUNT; i++)
+    if (Alarms[i].Active && (long)(Alarms[i].At - now) < ALARM_MIN)
+    {
+      Alarms[i].Active = 0;
+      Event_Post(Alarms[i].Event);
+      n++;
+    }
+  return n;
+}
+
+// Sets CCR1 to the earliest alarm. One that is more than a counter period
+// ahead is left to the overflow interrupt.
+static void Alarm_Arm(unsigned long now)
+{
+  unsigned long next = 0xFFFFFFFF, ahead;
+  unsigned char i;
+
+  for (i = 0; i < ALARM_COUNT; i++)
+    if (Alarms[i].Active)
+    {
+      ahead = Alarms[i].At - now;
+      if (ahead < next)
+        next = ahead;
+    }
+  if (next > 0xFFFF)
+  {
+    TACCTL1 = 0;
+    return;
+  }
+  TACCR1 = (unsigned int)(now + next);
+  TACCTL1 = CCIE;
+  if ((unsigned short)(Alarm_Counter() - (unsigned int)now) >= next)
+    TACCTL1 |= CCIFG;                        // passed meanwhile, interrupt at once
+}
+
+void Alarm_Set(unsigned char alarm, unsigned long at, unsigned char event)
+{
+  __istate_t state = __get_interrupt_state();
+  unsigned long now;
+
+  __disable_interrupt();
+  Alarms[alarm].At = at;
+  Alarms[alarm].Event = event;
+  Alarms[alarm].Active = 1;
+  now = Alarm_Now();
+  Alarm_Expire(now);
+  Alarm_Arm(now);
+  __set_interrupt_state(state);
+}
+
+void Alarm_Cancel(unsigned char alarm)
+{
+  __istate_t state = __get_interrupt_state();
+
+  unsigned long now;
+
+  __disable_interrupt();
+  Alarms[alarm].Active = 0;
+  now = Alarm_Now();
+  Alarm_Expire(now);
+  Alarm_Arm(now);
+  __set_interrupt_state(state);
+}
+
+#pragma vector=TIMERA1_VECTOR
+__interrupt void Alarm_Isr(void)
+{
+  unsigned long now;
+
+  Alarm_Wakeups++;
+  if (TAIV == 10)                            // TAIFG, reading TAIV clears it
+    Overflows++;                             // (2 = CCR1 needs nothing else)
+  now = Alarm_Now();
+  if (Alarm_Expire(now))
+    _BIC_SR_IRQ(LPM3_bits);                  // run the posted tasks
+  Alarm_Arm(now);
+}
@@ -0,0 +1,29 @@
+/*
+alarm.h - Tickless alarms and clock on Timer_A
+
+Timer_A counts ACLK/8 (4096 Hz) and is never stopped or reloaded. CCR1 is
+set to the earliest pending alarm, so the CPU only wakes up when an alarm
+is due and once per counter overflow (every 16 s), instead of on every
+tick. A due alarm posts its event (event.h) and leaves LPM3. The overflows
+extend the counter to the clock read by Alarm_Now() and Alarm_Seconds().
+
+*/
+
+#ifndef _alarm_h
+#define _alarm_h
+
+#define ALARM_HZ    4096                     // ACLK / 8
+#define ALARM_COUNT 4                        // alarms
+#define ALARM_TICKS(seconds) ((unsigned long)(seconds) * ALARM_HZ)
+
+void Alarm_Init(void);                       // start Timer_A, all alarms off
+unsigned long Alarm_Now(void);               // ticks since Alarm_Init(), wraps after 12 days
+unsigned long Alarm_Seconds(void);           // seconds since Alarm_Init()
+
+// posts 'event' at tick 'at' (at most 6 days ahead), replaces a pending one
+void Alarm_Set(unsigned char alarm, unsigned long at, unsigned char event);
+void Alarm_Cancel(unsigned char alarm);
+
+extern unsigned long Alarm_Wakeups;          // Timer_A interrupts so far
+
+#endif /* _alarm_h */
@@ -0,0 +1,32 @@
+//******************************************************************************
+//  chart.c - Static chart page, the values come from /data.csv
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "chart.h"
+
+const char Chart_Shell[] =
+"<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.01 Transitional//EN'>\r\n"
+"<html><head><title>MSP430 - Webserver</title>\r\n"
+"<script type='text/javascript' src='http://cdnjs.cloudflare.com/ajax/libs/dygraph/1.1.1/dygraph-combined.js'></script>\r\n"
+"</head>\r\n"
+"<body bgcolor='#444444'><font face='Verdana' color='#FFFFFF'>\r\n"
+"<h2><font color='#2076CD'>Webserver 1.0</font></h2>\r\n"
+"<p><b>Status: <span id='s'></span></b></p>\r\n"
+"<form method=get><input type=submit name=3 value='EIN'> <input type=submit name=3 value='AUS'></form>\r\n"
+"<p><a href='#' onclick='return show(\"h\")'>Stunde</a> "
+"<a href='#' onclick='return show(\"d\")'>Tag</a> "
+"<a href='#' onclick='return show(\"w\")'>Woche</a></p>\r\n"
+"<div id='c' style='width:800px; height:400px; background:#CCCCFF'></div>\r\n"
+"<script type='text/javascript'>\r\n"
+"function show(r){new Dygraph(document.getElementById('c'),'/data.csv?r='+r,"
+"{customBars:r!='h',ylabel:'Temperatur [&deg;C]'});return false;}\r\n"
+"var x=new XMLHttpRequest();"
+"x.onload=function(){document.getElementById('s').innerHTML=x.responseText;};"
+"x.open('GET','/status');x.send();\r\n"
+"show('h');\r\n"
+"</script></font></body></html>\r\n";
+
+const unsigned int Chart_Length = sizeof Chart_Shell - 1;
@@ -0,0 +1,18 @@
+/*
+chart.h - Static chart page, the values come from /data.csv
+
+The page never changes, so it is sent with a fixed Content-Length and an
+ETag; a browser that has it answers with If-None-Match and gets a 304.
+The chart (dygraphs) loads /data.csv?r=h|d|w, the status line /status.
+
+*/
+
+#ifndef _chart_h
+#define _chart_h
+
+#define CHART_ETAG "\"c1\""                  // change with the page
+
+extern const char Chart_Shell[];
+extern const unsigned int Chart_Length;      // bytes of Chart_Shell without the 0
+
+#endif /* _chart_h */
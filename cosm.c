@@ -0,0 +1,129 @@
+//******************************************************************************
+//  cosm.c - Cosm v2 CSV PUT with exact Content-Length
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "uart_tx.h"
+#include "format.h"
+#include "cosm.h"
+
+static const Cosm_Feed *Feed;                // feed of the running Cosm_Put()
+static unsigned char Sizing;                 // first pass, count only
+static unsigned int Length;                  // body length of the first pass
+static unsigned char Rows;                   // rows of the current pass
+static char Line[COSM_LINE];                 // reply line, cut at COSM_LINE - 1
+static unsigned char LineLength;
+static Csv_Stamp Date;                       // of the last Date: header
+static unsigned char DateValid;
+
+static void Cosm_Text(const char *s)
+{
+  if (!Sizing)
+  {
+    printf(s);
+    return;
+  }
+  while (*s++)
+    Length++;
+}
+
+// characters of Format_Fixed(value, decimals)
+static unsigned char Cosm_ValueLength(int value, unsigned char decimals)
+{
+  unsigned int magnitude = value < 0 ? -(unsigned int)value : value;
+  unsigned char n = Format_Length(magnitude);
+
+  if (decimals)
+  {
+    if (n <= decimals)
+      n = decimals + 1;                      // leading "0"
+    n++;                                     // decimal point
+  }
+  return n + (value < 0);
+}
+
+void Cosm_Row(unsigned char stream, const Csv_Stamp *t, int value)
+{
+  const Cosm_Stream *s = &Feed->Streams[stream];
+
+  if (Rows++)
+    Cosm_Text("\n");
+  Cosm_Text(s->Id);
+  Cosm_Text(",");
+  if (t)
+  {
+    if (Sizing)
+      Length += CSV_ISO_LENGTH;
+    else
+      Csv_Iso(t);
+    Cosm_Text(",");
+  }
+  if (Sizing)
+    Length += Cosm_ValueLength(value, s->Decimals);
+  else
+    Format_Fixed(value, s->Decimals);
+}
+
+void Cosm_Put(const Cosm_Feed *feed, Cosm_Body body)
+{
+  Feed = feed;
+  Sizing = 1;
+  Length = 0;
+  Rows = 0;
+  body(feed);
+
+  printf("PUT /v2/feeds/");
+  printf(feed->FeedId);
+  printfln(".csv HTTP/1.1");
+  printfln("Host: api.cosm.com");
+  printf("X-ApiKey: ");
+  printfln(feed->ApiKey);
+  printf("User-Agent: ");
+  printfln(feed->UserAgent);
+  printf("Content-Length: ");
+  Format_Unsigned(Length);
+  printfln("");
+  printfln("Content-Type: text/csv");
+  printfln("Connection: close");
+  printfln("");
+
+  Sizing = 0;
+  Rows = 0;
+  body(feed);
+}
+
+unsigned char Cosm_Receive(unsigned char c)
+{
+  static const char header[] = "Date: ";
+  unsigned char i;
+
+  if (c != '\n')
+  {
+    if (c != '\r' && LineLength < COSM_LINE - 1)
+      Line[LineLength++] = c;
+    return 0;
+  }
+  Line[LineLength] = 0;
+  LineLength = 0;
+  for (i = 0; header[i]; i++)
+    if (Line[i] != header[i])
+      return 0;
+  if (!Csv_HttpDate(&Date, Line + i))
+    return 0;
+  DateValid = 1;
+  return 1;
+}
+
+unsigned char Cosm_Date(Csv_Stamp *t)
+{
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();                     // Cosm_Receive() runs in the RX ISR
+  *t = Date;
+  __set_interrupt_state(state);
+  return DateValid;
+}
@@ -0,0 +1,48 @@
+/*
+cosm.h - Cosm v2 CSV PUT with exact Content-Length
+
+Cosm_Put() calls the body function twice. In the first pass Cosm_Row()
+only adds up the length of the formatted row, in the second one it sends
+it. So the header carries the exact Content-Length and the body is
+streamed without a buffer. The body function has to produce the same
+rows in both passes.
+
+Rows are "id,value" or, with a time stamp, "id,timestamp,value",
+separated by '\n'.
+
+Cosm_Receive() reads the reply byte by byte from the RX ISR and keeps the
+time of its Date: header for Cosm_Date(), the clock of the logger.
+
+*/
+
+#ifndef _cosm_h
+#define _cosm_h
+
+#include "csv.h"
+
+typedef struct
+{
+  const char *Id;                            // datastream id
+  unsigned char Decimals;                    // fixed point format of the values
+} Cosm_Stream;
+
+typedef struct
+{
+  const char *FeedId;
+  const char *ApiKey;
+  const char *UserAgent;
+  const Cosm_Stream *Streams;
+  unsigned char Count;
+} Cosm_Feed;
+
+typedef void (*Cosm_Body)(const Cosm_Feed *feed);
+
+void Cosm_Put(const Cosm_Feed *feed, Cosm_Body body);
+void Cosm_Row(unsigned char stream, const Csv_Stamp *t, int value); // t = 0: no time stamp
+
+#define COSM_LINE 40                         // reply line buffer, "Date: ..." is 35
+
+unsigned char Cosm_Receive(unsigned char c); // from the RX ISR, 1 = Date: read
+unsigned char Cosm_Date(Csv_Stamp *t);       // time of the last Date:, 0 = none yet
+
+#endif /* _cosm_h */
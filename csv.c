@@ -0,0 +1,140 @@
+//******************************************************************************
+//  csv.c - Date column of the CSV files read by dygraphs
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "uart_tx.h"
+#include "format.h"
+#include "csv.h"
+
+#define MINUTES_PER_DAY (24 * 60)
+
+static const unsigned char Csv_Days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+static const char Csv_Months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+static unsigned char Csv_MonthDays(const Csv_Stamp *t)
+{
+  if (t->Month == 2 && (t->Year & 3) == 0)
+    return 29;
+  return Csv_Days[t->Month - 1];
+}
+
+void Csv_Back(Csv_Stamp *t, unsigned int minutes)
+{
+  while (minutes > t->Minute)
+  {
+    t->Minute += MINUTES_PER_DAY;
+    if (--t->Day == 0)
+    {
+      if (--t->Month == 0)
+      {
+        t->Month = 12;
+        t->Year--;
+      }
+      t->Day = Csv_MonthDays(t);
+    }
+  }
+  t->Minute -= minutes;
+}
+
+void Csv_Forward(Csv_Stamp *t, unsigned int minutes)
+{
+  t->Minute += minutes;
+  if (t->Minute < MINUTES_PER_DAY)
+    return;
+  t->Minute -= MINUTES_PER_DAY;
+  if (++t->Day > Csv_MonthDays(t))
+  {
+    t->Day = 1;
+    if (++t->Month > 12)
+    {
+      t->Month = 1;
+      t->Year++;
+    }
+  }
+}
+
+static void Csv_Put(const Csv_Stamp *t, const char *dash, const char *space)
+{
+  unsigned int m = t->Minute;
+  unsigned char h = 0;
+
+  while (m >= 60)
+  {
+    m -= 60;
+    h++;
+  }
+  Format_Unsigned(t->Year);
+  printf(dash);
+  Format_Width(t->Month, 2, '0');
+  printf(dash);
+  Format_Width(t->Day, 2, '0');
+  printf(space);
+  Format_Width(h, 2, '0');
+  printf(":");
+  Format_Width(m, 2, '0');
+}
+
+void Csv_Date(const Csv_Stamp *t)
+{
+  Csv_Put(t, "/", " ");
+}
+
+void Csv_Iso(const Csv_Stamp *t)
+{
+  Csv_Put(t, "-", "T");
+  printf(":00Z");
+}
+
+// 'digits' decimal digits followed by 'end', 0xFFFF if the text differs
+static unsigned int Csv_Number(const char **s, unsigned char digits, char end)
+{
+  const char *p = *s;
+  unsigned int n = 0;
+
+  while (digits--)
+  {
+    if (*p < '0' || *p > '9')
+      return 0xFFFF;
+    n = n * 10 + (*p++ - '0');
+  }
+  if (*p++ != end)
+    return 0xFFFF;
+  *s = p;
+  return n;
+}
+
+unsigned char Csv_HttpDate(Csv_Stamp *t, const char *s)
+{
+  Csv_Stamp d;
+  unsigned int day, year, hour, minute;
+  unsigned char month;
+
+  while (*s && *s != ' ')                    // weekday
+    s++;
+  if (*s++ != ' ')
+    return 0;
+  day = Csv_Number(&s, 2, ' ');
+  for (month = 0; month < 12; month++)
+    if (s[0] == Csv_Months[month * 3] && s[1] == Csv_Months[month * 3 + 1]
+        && s[2] == Csv_Months[month * 3 + 2] && s[3] == ' ')
+      break;
+  if (month == 12)
+    return 0;
+  s += 4;
+  year = Csv_Number(&s, 4, ' ');
+  hour = Csv_Number(&s, 2, ':');
+  minute = Csv_Number(&s, 2, ':');
+  if (year < 1000 || year > 9999 || hour > 23 || minute > 59)
+    return 0;
+  d.Year = year;
+  d.Month = month + 1;
+  if (day == 0 || day > Csv_MonthDays(&d))
+    return 0;
+  d.Day = day;
+  d.Minute = hour * 60 + minute;             // seconds are dropped
+  *t = d;
+  return 1;
+}
@@ -0,0 +1,32 @@
+/*
+csv.h - Date column of the CSV files read by dygraphs
+
+A row starts with "YYYY/MM/DD hh:mm". Csv_Back() moves a stamp to the
+first row, Csv_Forward() steps from row to row, so no date is divided.
+Csv_Iso() sends the same stamp as ISO 8601 UTC time for Cosm,
+Csv_HttpDate() reads the Date: header of its reply.
+
+*/
+
+#ifndef _csv_h
+#define _csv_h
+
+typedef struct
+{
+  int Year;
+  unsigned char Month;                       // 1..12
+  unsigned char Day;                         // 1..31
+  unsigned int Minute;                       // of the day, 0..1439
+} Csv_Stamp;
+
+void Csv_Back(Csv_Stamp *t, unsigned int minutes);
+void Csv_Forward(Csv_Stamp *t, unsigned int minutes); // max. one day
+void Csv_Date(const Csv_Stamp *t);           // sends the date column
+void Csv_Iso(const Csv_Stamp *t);            // sends "YYYY-MM-DDThh:mm:00Z"
+// "Sun, 06 Nov 1994 08:49:37 GMT" (RFC 1123), leaves t alone and returns 0
+// when the text differs
+unsigned char Csv_HttpDate(Csv_Stamp *t, const char *s);
+
+#define CSV_ISO_LENGTH 20                    // Csv_Iso() for years 1000..9999
+
+#endif /* _csv_h */
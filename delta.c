@@ -0,0 +1,223 @@
+//******************************************************************************
+//  delta.c - Delta compressed sample stream in a fixed nibble ring
+//
+//  Temperatures drift slowly: at 0.5 deg C resolution most one minute
+//  differences are 0 or +-1, so a quiet hour costs a few bytes instead of
+//  60. A run of unchanged samples is held back in 'Run' until it ends; a
+//  reader treats samples behind 'Head' as unchanged.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "delta.h"
+
+#define NIBBLES   (DELTA_BYTES * 2)
+#define CODE_RUN  0x0C
+#define CODE_WIDE 0x0D
+#define CODE_KEY  0x0E
+#define SMALL_MAX 12                         // zigzag codes in one nibble
+#define RUN_MAX   17
+
+// a full block must fit into the ring: the keyframe is 4 nibbles, every
+// further sample at most 5 (E v v v v)
+typedef char Delta_Size_Check[NIBBLES >= 4 + 5 * (DELTA_KEYFRAME - 1) && NIBBLES < 0x8000 ? 1 : -1];
+
+static unsigned char Slot(unsigned char block)
+{
+  return block >= DELTA_BLOCKS ? block - DELTA_BLOCKS : block;
+}
+
+static unsigned char Nibble(const Delta_Stream *s, unsigned int pos)
+{
+  unsigned char b = s->Data[pos >> 1];
+
+  return pos & 1 ? b & 0x0F : b >> 4;
+}
+
+static void Drop(Delta_Stream *s)
+{
+  s->First = Slot(s->First + 1);
+  s->Blocks--;
+}
+
+static void Put(Delta_Stream *s, unsigned char n)
+{
+  unsigned char *b = &s->Data[s->Head >> 1];
+
+  if (s->Blocks > 1 && s->Head == s->Start[s->First])
+    Drop(s);                                 // ring full
+  if (s->Head & 1)
+    *b = (*b & 0xF0) | n;
+  else
+    *b = (*b & 0x0F) | (n << 4);
+  if (++s->Head == NIBBLES)
+    s->Head = 0;
+}
+
+static void PutValue(Delta_Stream *s, int value)
+{
+  Put(s, ((unsigned int)value >> 12) & 0x0F);
+  Put(s, (value >> 8) & 0x0F);
+  Put(s, (value >> 4) & 0x0F);
+  Put(s, value & 0x0F);
+}
+
+static void FlushRun(Delta_Stream *s)
+{
+  if (s->Run == 1)
+    Put(s, 0);
+  else if (s->Run > 1)
+  {
+    Put(s, CODE_RUN);
+    Put(s, s->Run - 2);
+  }
+  s->Run = 0;
+}
+
+void Delta_Init(Delta_Stream *s)
+{
+  s->Head = 0;
+  s->First = 0;
+  s->Blocks = 0;
+  s->Fill = 0;
+  s->Run = 0;
+}
+
+void Delta_Add(Delta_Stream *s, int value)
+{
+  int d = value - s->Last;
+  unsigned int z = (d << 1) ^ (d >> 15);     // zigzag: 0, -1, 1, -2, ...
+
+  if (s->Blocks == 0 || s->Fill == DELTA_KEYFRAME)
+  {
+    FlushRun(s);
+    if (s->Blocks == DELTA_BLOCKS)
+      Drop(s);
+    s->Start[Slot(s->First + s->Blocks)] = s->Head;
+    s->Blocks++;
+    PutValue(s, value);                      // keyframe
+    s->Fill = 1;
+    s->Last = value;
+    return;
+  }
+  s->Fill++;
+  s->Last = value;
+
+  if (d == 0)
+  {
+    if (++s->Run == RUN_MAX)
+      FlushRun(s);
+    return;
+  }
+  FlushRun(s);
+  if (z < SMALL_MAX)
+    Put(s, z);
+  else if (z < SMALL_MAX + 256)
+  {
+    z -= SMALL_MAX;
+    Put(s, CODE_WIDE);
+    Put(s, z >> 4);
+    Put(s, z & 0x0F);
+  }
+  else
+  {
+    Put(s, CODE_KEY);
+    PutValue(s, value);
+  }
+}
+
+unsigned int Delta_Count(const Delta_Stream *s)
+{
+  if (s->Blocks == 0)
+    return 0;
+  return (s->Blocks - 1) * DELTA_KEYFRAME + s->Fill;
+}
+
+static unsigned char Get(Delta_Reader *r)
+{
+  unsigned char n = Nibble(r->Stream, r->Pos);
+
+  if (++r->Pos == NIBBLES)
+    r->Pos = 0;
+  return n;
+}
+
+static int GetValue(Delta_Reader *r)
+{
+  unsigned int v = Get(r) << 12;
+
+  v |= Get(r) << 8;
+  v |= Get(r) << 4;
+  return v | Get(r);
+}
+
+// positions the reader on the keyframe of a block
+static void Key(Delta_Reader *r, unsigned char block)
+{
+  const Delta_Stream *s = r->Stream;
+
+  r->Block = block;
+  r->Pos = s->Start[block];
+  r->Run = 0;
+  r->Left = block == Slot(s->First + s->Blocks - 1) ? s->Fill : DELTA_KEYFRAME;
+  r->Left--;
+  r->Value = GetValue(r);
+}
+
+int Delta_Seek(Delta_Reader *r, const Delta_Stream *s, unsigned int i)
+{
+  unsigned char block = s->First;
+
+  r->Stream = s;
+  while (i >= DELTA_KEYFRAME)
+  {
+    i -= DELTA_KEYFRAME;
+    block = Slot(block + 1);
+  }
+  Key(r, block);
+  while (i--)
+    Delta_Next(r);
+  return r->Value;
+}
+
+int Delta_Next(Delta_Reader *r)
+{
+  unsigned char n;
+  unsigned int z;
+
+  if (r->Left == 0)
+  {
+    Key(r, Slot(r->Block + 1));
+    return r->Value;
+  }
+  r->Left--;
+  if (r->Run)
+  {
+    r->Run--;
+    return r->Value;
+  }
+  if (r->Pos == r->Stream->Head)
+    return r->Value;                         // run not written yet
+
+  n = Get(r);
+  if (n < SMALL_MAX)
+    z = n;
+  else if (n == CODE_RUN)
+  {
+    r->Run = Get(r) + 1;                     // this sample is the first of n + 2
+    return r->Value;
+  }
+  else if (n == CODE_WIDE)
+  {
+    z = Get(r) << 4;
+    z = (z | Get(r)) + SMALL_MAX;
+  }
+  else
+  {
+    r->Value = GetValue(r);
+    return r->Value;
+  }
+  r->Value += (z >> 1) ^ -(int)(z & 1);
+  return r->Value;
+}
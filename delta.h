@@ -0,0 +1,56 @@
+/*
+delta.h - Delta compressed sample stream in a fixed nibble ring
+
+Every DELTA_KEYFRAME samples a block starts with the full value, so a
+sample is found by decoding at most one block. Between keyframes only the
+zigzag coded difference to the previous sample is stored:
+
+  0..B      difference -6..+5 in one nibble (0 = unchanged)
+  C n       n + 2 unchanged samples
+  D h l     difference with zigzag code 12..267
+  E v v v v new 16 bit value
+
+When the ring is full, the oldest block is dropped. A sample costs 5
+nibbles in the worst case, so DELTA_BYTES holds at least one block; the
+retention of real signals is measured by test/delta_test.c.
+
+*/
+
+#ifndef _delta_h
+#define _delta_h
+
+#ifndef DELTA_BYTES
+#define DELTA_BYTES    240                   // ring size per stream
+#endif
+#define DELTA_KEYFRAME 60                    // samples per block
+#define DELTA_BLOCKS   25                    // at most a day plus the open block
+
+typedef struct
+{
+  unsigned char Data[DELTA_BYTES];           // nibbles, high nibble first
+  unsigned int Start[DELTA_BLOCKS];          // nibble position of the keyframes
+  unsigned int Head;                         // next nibble position
+  int Last;                                  // last value added
+  unsigned char First;                       // oldest block
+  unsigned char Blocks;                      // blocks in use, incl. the open one
+  unsigned char Fill;                        // samples in the open block
+  unsigned char Run;                         // unchanged samples not yet written
+} Delta_Stream;
+
+typedef struct
+{
+  const Delta_Stream *Stream;
+  unsigned int Pos;                          // next nibble
+  int Value;                                 // last value read
+  unsigned char Block;
+  unsigned char Left;                        // samples left in the block
+  unsigned char Run;                         // unchanged samples left
+} Delta_Reader;
+
+void Delta_Init(Delta_Stream *s);
+void Delta_Add(Delta_Stream *s, int value);
+unsigned int Delta_Count(const Delta_Stream *s);
+int Delta_Seek(Delta_Reader *r, const Delta_Stream *s, unsigned int i); // sample i, 0 = oldest
+int Delta_Next(Delta_Reader *r);             // sample after the last one read
+
+#endif /* _delta_h */
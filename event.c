@@ -0,0 +1,47 @@
+//******************************************************************************
+//  event.c - Events posted by interrupts, run as tasks from the main loop
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "event.h"
+
+static volatile unsigned char Pending[EVENT_TYPES];   // posts not handled yet
+unsigned char Event_Dropped;
+
+void Event_Post(unsigned char event)
+{
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();
+  if (Pending[event] < EVENT_LIMIT)
+    Pending[event]++;
+  else
+    Event_Dropped++;
+  __set_interrupt_state(state);
+}
+
+// Interrupts are disabled while the pending events are looked at, so a post
+// between the check and _BIS_SR(LPM3_bits + GIE) can not get lost.
+void Event_Run(const Event_Task *tasks, unsigned char count)
+{
+  unsigned char i;
+
+  for (;;)
+  {
+    __disable_interrupt();
+    for (i = 0; i < count && !Pending[i]; i++)
+      ;
+    if (i == count)
+    {
+      _BIS_SR(LPM3_bits + GIE);              // Enter LPM3 w/ interrupt
+      continue;
+    }
+    Pending[i]--;
+    __enable_interrupt();
+    tasks[i]();
+  }
+}
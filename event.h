@@ -0,0 +1,26 @@
+/*
+event.h - Events posted by interrupts, run as tasks from the main loop
+
+An ISR only calls Event_Post() and leaves LPM3 with _BIC_SR_IRQ(LPM3_bits).
+Event_Run() runs the task of the pending event with the highest priority
+(lowest number) to completion, one at a time, and sleeps in LPM3 while
+nothing is pending. Posts of an event that is not handled yet are counted
+up to EVENT_LIMIT, further ones are lost and counted in Event_Dropped.
+
+*/
+
+#ifndef _event_h
+#define _event_h
+
+#define EVENT_TYPES 8                        // max. events, number = priority
+#define EVENT_LIMIT 4                        // posts kept per event
+
+typedef void (*Event_Task)(void);
+
+void Event_Post(unsigned char event);        // from ISRs and tasks
+// runs tasks[event] for each posted event, never returns
+void Event_Run(const Event_Task *tasks, unsigned char count);
+
+extern unsigned char Event_Dropped;
+
+#endif /* _event_h */
@@ -0,0 +1,270 @@
+//******************************************************************************
+//  flashlog.c - Wear-levelled sample log in the main flash of the MSP430F149
+//
+//  Startup: the sequence numbers of the segments 0..head count up by one,
+//  so the head is found by a binary search over the segment headers, and
+//  the first free record in the head segment by another one.
+//
+//  Flash timing: the CPU is held while flash is busy, so interrupts are
+//  disabled (the vectors are in flash) for one byte (~90us) at a time.
+//  Only the erase of a segment takes ~15ms, once per FLASHLOG_RECORDS
+//  records. That is 15 characters at 9600 baud, so the erase runs from RAM
+//  and polls URXIFG0; the bytes go to the RX function before interrupts
+//  are enabled again, so they stay in order with the ones the ISR gets.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "flashlog.h"
+
+#define FLASHLOG_RECORDS ((FLASHLOG_SEGMENT_SIZE - sizeof (FlashLog_Header)) / sizeof (FlashLog_Record))
+#define SEQ_MASK 0x7FFF                      // bit 15 set = erased header
+
+typedef struct
+{
+  unsigned short Seq;
+  unsigned short Check;                      // ~Seq, rejects old contents
+} FlashLog_Header;
+
+// keeps the linker from placing code into the log area
+#pragma location=FLASHLOG_START
+__no_init const unsigned char FlashLog_Area[FLASHLOG_SEGMENTS * FLASHLOG_SEGMENT_SIZE];
+
+typedef char FlashLog_Segments_Check[FLASHLOG_SEGMENTS >= 3 && FLASHLOG_SEGMENTS < 256 ? 1 : -1];
+
+static unsigned char Head;                   // segment written to
+static unsigned char Fill;                   // records in the head segment
+static unsigned short Sequence;                // sequence number of the head segment
+static FlashLog_Record Batch;                // filled by FlashLog_Add()
+static FlashLog_Rx RxHandler;                // bytes received during an erase
+
+unsigned long FlashLog_Minute = 0;
+volatile unsigned char FlashLog_Dropped = 0;
+
+static const unsigned char *Segment(unsigned char seg)
+{
+  return FlashLog_Area + (unsigned int)seg * FLASHLOG_SEGMENT_SIZE;
+}
+
+static unsigned short Seq(unsigned char seg)
+{
+  return ((const FlashLog_Header *)Segment(seg))->Seq;
+}
+
+static unsigned char Valid(unsigned char seg)
+{
+  const FlashLog_Header *h = (const FlashLog_Header *)Segment(seg);
+
+  return (h->Seq & ~SEQ_MASK) == 0 && h->Check == (unsigned short)~h->Seq;
+}
+
+static unsigned char Next(unsigned char seg)
+{
+  return seg + 1 == FLASHLOG_SEGMENTS ? 0 : seg + 1;
+}
+
+static const FlashLog_Record *Record(unsigned char seg, unsigned char i)
+{
+  return (const FlashLog_Record *)(Segment(seg) + sizeof (FlashLog_Header)) + i;
+}
+
+static unsigned short Crc(const unsigned char *p, unsigned char n)
+{
+  unsigned short crc = 0xFFFF;
+  unsigned char i;
+
+  while (n--)
+  {
+    crc ^= (unsigned int)*p++ << 8;
+    for (i = 0; i < 8; i++)
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// Runs from RAM, no flash access until BUSY is clear. Returns the number
+// of bytes received meanwhile.
+static __ramfunc unsigned char Flash_EraseRam(volatile unsigned char *seg, unsigned char *rx)
+{
+  unsigned char n = 0;
+
+  FCTL3 = FWKEY;                             // unlock
+  FCTL1 = FWKEY + ERASE;
+  *seg = 0;                                  // dummy write starts the erase
+  while (FCTL3 & BUSY)
+    if ((IFG1 & URXIFG0) && n < FLASHLOG_RX_SIZE)
+      rx[n++] = RXBUF0;                      // reading clears URXIFG0
+  FCTL1 = FWKEY;
+  FCTL3 = FWKEY + LOCK;
+  return n;
+}
+
+static void Flash_Erase(unsigned char seg)
+{
+  unsigned char rx[FLASHLOG_RX_SIZE];
+  unsigned char i, n;
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();
+  n = Flash_EraseRam((volatile unsigned char *)Segment(seg), rx);
+  for (i = 0; i < n; i++)                    // before the ISR gets newer bytes
+    RxHandler(rx[i]);
+  __set_interrupt_state(state);
+}
+
+static void Flash_Write(const unsigned char *dst, const void *src, unsigned char n)
+{
+  const unsigned char *s = src;
+  __istate_t state = __get_interrupt_state();
+
+  for (; n; n--)
+  {
+    __disable_interrupt();
+    FCTL3 = FWKEY;
+    FCTL1 = FWKEY + WRT;
+    *(volatile unsigned char *)dst++ = *s++;
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY + LOCK;
+    __set_interrupt_state(state);
+  }
+}
+
+// starts the next segment and erases the one after it
+static void Advance(void)
+{
+  FlashLog_Header h;
+
+  Head = Next(Head);
+  Sequence = (Sequence + 1) & SEQ_MASK;
+  h.Seq = Sequence;
+  h.Check = ~Sequence;
+  Flash_Write(Segment(Head), &h, sizeof h);
+  Fill = 0;
+  Flash_Erase(Next(Head));
+}
+
+static unsigned char Oldest(void)
+{
+  unsigned char seg = Next(Next(Head));
+
+  return Valid(seg) ? seg : 0;
+}
+
+void FlashLog_Init(FlashLog_Rx rx)
+{
+  unsigned char lo, hi, mid;
+  const FlashLog_Record *last;
+
+  RxHandler = rx;
+  FCTL2 = FWKEY + FSSEL_1 + FN0;             // MCLK/2 ~400kHz flash timing
+
+  if (Valid(0))
+  {
+    lo = 0;                                  // last segment continuing the sequence of 0
+    hi = FLASHLOG_SEGMENTS - 1;
+    while (lo < hi)
+    {
+      mid = (lo + hi + 1) / 2;
+      if (Valid(mid) && ((Seq(mid) - Seq(0)) & SEQ_MASK) == mid)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+    Head = lo;
+  }
+  else if (Valid(FLASHLOG_SEGMENTS - 1))     // wrapped, segment 0 erased
+    Head = FLASHLOG_SEGMENTS - 1;
+  else                                       // new log
+  {
+    for (lo = 0; lo < FLASHLOG_SEGMENTS; lo++)
+      Flash_Erase(lo);
+    Head = FLASHLOG_SEGMENTS - 1;
+    Sequence = SEQ_MASK;
+    Advance();
+    return;
+  }
+  Sequence = Seq(Head);
+
+  lo = 0;                                    // first free record
+  hi = FLASHLOG_RECORDS;
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+    if (Record(Head, mid)->Count != 0xFF)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  Fill = lo;
+
+  if (Valid(Next(Head)))                     // reset during Advance()
+    Flash_Erase(Next(Head));
+
+  if (FlashLog_Count() != 0)
+  {
+    last = FlashLog_Get(FlashLog_Count() - 1);
+    if (last)
+      FlashLog_Minute = last->Minute + last->Count;
+  }
+}
+
+unsigned char FlashLog_Add(const int *values)
+{
+  unsigned char s;
+
+  if (Batch.Count == FLASHLOG_BATCH)         // not flushed in time
+  {
+    FlashLog_Dropped++;
+    FlashLog_Minute++;
+    return 1;
+  }
+  if (Batch.Count == 0)
+    Batch.Minute = FlashLog_Minute;
+  for (s = 0; s < HISTORY_SENSORS; s++)
+    Batch.Data[Batch.Count][s] = History_Pack(values[s]);
+  FlashLog_Minute++;
+  return ++Batch.Count == FLASHLOG_BATCH;
+}
+
+void FlashLog_Flush(void)
+{
+  if (Batch.Count == 0)
+    return;
+
+  Batch.Reserved = 0;
+  Batch.Crc = Crc((const unsigned char *)&Batch, sizeof Batch - sizeof Batch.Crc);
+  if (Fill == FLASHLOG_RECORDS)
+    Advance();
+  Flash_Write((const unsigned char *)Record(Head, Fill), &Batch, sizeof Batch); // Count first
+  Fill++;
+  Batch.Count = 0;
+}
+
+unsigned int FlashLog_Count(void)
+{
+  int full = Head - Oldest();
+
+  if (full < 0)
+    full += FLASHLOG_SEGMENTS;
+  return full * FLASHLOG_RECORDS + Fill;
+}
+
+const FlashLog_Record *FlashLog_Get(unsigned int i)
+{
+  unsigned char seg = Oldest();
+  const FlashLog_Record *r;
+
+  while (i >= FLASHLOG_RECORDS)
+  {
+    i -= FLASHLOG_RECORDS;
+    seg = Next(seg);
+  }
+  r = Record(seg, i);
+  if (r->Count == 0 || r->Count > FLASHLOG_BATCH
+      || Crc((const unsigned char *)r, sizeof *r - sizeof r->Crc) != r->Crc)
+    return 0;
+  return r;
+}
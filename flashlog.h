@@ -0,0 +1,54 @@
+/*
+flashlog.h - Wear-levelled sample log in the main flash of the MSP430F149
+
+The log uses FLASHLOG_SEGMENTS segments of 512 bytes from FLASHLOG_START
+as a ring. Every segment starts with a 15 bit sequence number (and its
+complement), followed by
+records of FLASHLOG_BATCH samples with a CRC each. The segment after the
+write head is always kept erased, so the oldest segment is overwritten
+last and every segment is erased once per round.
+
+FlashLog_Add() copies a sample into a RAM batch, FlashLog_Flush()
+programs it; both belong in the main loop. A segment erase keeps
+interrupts off for ~15ms, so it polls USART0 meanwhile and hands the
+bytes received to the FlashLog_Rx function given to FlashLog_Init().
+
+*/
+
+#ifndef _flashlog_h
+#define _flashlog_h
+
+#include "history.h"
+
+#ifndef FLASHLOG_START
+#define FLASHLOG_START    0xD000             // must not be used by code
+#endif
+#ifndef FLASHLOG_SEGMENTS
+#define FLASHLOG_SEGMENTS 16                 // 8 KB, ~2 days of minute values
+#endif
+#define FLASHLOG_SEGMENT_SIZE 512
+#define FLASHLOG_BATCH    15                 // samples per record
+
+typedef struct
+{
+  unsigned char Count;                       // samples in Data, 0xFF = free
+  unsigned char Reserved;
+  unsigned long Minute;                      // log minute of the first sample
+  unsigned char Data[FLASHLOG_BATCH][HISTORY_SENSORS]; // History_Pack() format
+  unsigned short Crc;                        // CRC-16/CCITT of the bytes before
+} FlashLog_Record;
+
+#define FLASHLOG_RX_SIZE 24                  // bytes held during an erase, 19ms at 9600 baud
+
+typedef void (*FlashLog_Rx)(unsigned char c);
+
+void FlashLog_Init(FlashLog_Rx rx);          // finds the write head, call before GIE
+unsigned char FlashLog_Add(const int *values); // returns 1 when the batch is full
+void FlashLog_Flush(void);                   // programs the batch
+unsigned int FlashLog_Count(void);           // records in the log
+const FlashLog_Record *FlashLog_Get(unsigned int i); // 0 = oldest, 0 if CRC fails
+
+extern unsigned long FlashLog_Minute;        // log minute of the next sample
+extern volatile unsigned char FlashLog_Dropped; // samples lost, batch not flushed
+
+#endif /* _flashlog_h */
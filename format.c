@@ -0,0 +1,169 @@
+//******************************************************************************
+//  format.c - Division free number output straight into the TX buffer
+//
+//  The F149 has no hardware divider, so ltoa_format() needed a software
+//  long division for every digit. Here the value is split into pairs of
+//  digits: v / 100 is calculated as (v * 41944) >> 22 with the hardware
+//  multiplier (exact for v < 43690), the two digits come from a table.
+//  So a 5 digit number costs 2 multiplications instead of 5 divisions.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "uart_tx.h"
+#include "format.h"
+
+#define FORMAT_DIGITS 5                      // 65535
+
+static const char Format_DigitPairs[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// v / 100 for v < 43690 with the hardware multiplier: (v * 0xA3D8) >> 22.
+// Interrupts are locked, the compiler uses MPY in ISRs as well.
+static unsigned int Format_Div100(unsigned int v)
+{
+  __istate_t state = __get_interrupt_state();
+  unsigned int q;
+
+  __disable_interrupt();
+  MPY = v;
+  OP2 = 0xA3D8;
+  q = RESHI >> 6;
+  __set_interrupt_state(state);
+  return q;
+}
+
+// writes the digits of 'value' right aligned in front of 'end',
+// returns the position of the first digit
+static char *Format_Digits(char *end, unsigned int value)
+{
+  unsigned int q;
+  const char *pair;
+
+  if (value >= 40000)                        // keep Format_Div100() exact
+  {
+    q = 400 + Format_Div100(value - 40000);
+    pair = &Format_DigitPairs[(value - q * 100) << 1];
+    *--end = pair[1];
+    *--end = pair[0];
+    value = q;
+  }
+  while (value >= 100)
+  {
+    q = Format_Div100(value);
+    pair = &Format_DigitPairs[(value - q * 100) << 1];
+    *--end = pair[1];
+    *--end = pair[0];
+    value = q;
+  }
+  if (value >= 10)
+  {
+    pair = &Format_DigitPairs[value << 1];
+    *--end = pair[1];
+    *--end = pair[0];
+  }
+  else
+    *--end = '0' + value;
+  return end;
+}
+
+static unsigned char Format_Send(const char *s, const char *end)
+{
+  unsigned char n = end - s;
+
+  while (s < end)
+    sendByte(*s++);
+  return n;
+}
+
+unsigned char Format_Unsigned(unsigned int value)
+{
+  char digits[FORMAT_DIGITS];
+  char *end = digits + FORMAT_DIGITS;
+
+  return Format_Send(Format_Digits(end, value), end);
+}
+
+unsigned char Format_Signed(int value)
+{
+  if (value < 0)
+  {
+    sendByte('-');
+    return 1 + Format_Unsigned(-(unsigned int)value);
+  }
+  return Format_Unsigned(value);
+}
+
+// right aligned in 'width' characters, filled with 'fill' (e.g. '0' for minutes)
+unsigned char Format_Width(unsigned int value, unsigned char width, char fill)
+{
+  char digits[FORMAT_DIGITS];
+  char *end = digits + FORMAT_DIGITS;
+  char *s = Format_Digits(end, value);
+  unsigned char n;
+
+  for (n = end - s; n < width; n++)
+    sendByte(fill);
+  Format_Send(s, end);
+  return n;
+}
+
+// the zeros between '.' and the digits are sent directly, so any number of
+// decimals fits the digit buffer
+unsigned char Format_Fixed(int value, unsigned char decimals)
+{
+  char digits[FORMAT_DIGITS];
+  char *end = digits + FORMAT_DIGITS;
+  char *s;
+  unsigned char n = 0, k;
+
+  if (value < 0)
+  {
+    sendByte('-');
+    n++;
+    s = Format_Digits(end, -(unsigned int)value);
+  }
+  else
+    s = Format_Digits(end, value);
+
+  k = end - s;                               // digits
+  if (k > decimals)
+  {
+    n += Format_Send(s, s + (k - decimals));
+    s += k - decimals;
+  }
+  else
+  {
+    sendByte('0');                           // at least one digit before '.'
+    n++;
+  }
+  if (decimals)
+  {
+    sendByte('.');
+    n++;
+    for (; k < decimals; k++, n++)
+      sendByte('0');
+    n += Format_Send(s, end);
+  }
+  return n;
+}
+
+unsigned char Format_Length(unsigned int value)
+{
+  if (value < 10)
+    return 1;
+  if (value < 100)
+    return 2;
+  if (value < 1000)
+    return 3;
+  if (value < 10000)
+    return 4;
+  return 5;
+}
@@ -0,0 +1,21 @@
+/*
+format.h - Division free number output straight into the TX buffer
+
+All functions send the digits with sendByte() and return the number of
+characters sent. Values are 16 bit, fixed point values are passed as
+integer with the number of decimals, e.g. Format_Fixed(235, 1) = "23.5".
+Any number of decimals works, Format_Fixed(5, 7) = "0.0000005"; as the
+count is an unsigned char, decimals must stay below 248.
+
+*/
+
+#ifndef _format_h
+#define _format_h
+
+unsigned char Format_Unsigned(unsigned int value);
+unsigned char Format_Signed(int value);
+unsigned char Format_Width(unsigned int value, unsigned char width, char fill);
+unsigned char Format_Fixed(int value, unsigned char decimals);
+unsigned char Format_Length(unsigned int value);        // digits, nothing is sent
+
+#endif /* _format_h */
@@ -0,0 +1,180 @@
+//******************************************************************************
+//  history.c - Sensor history in three resolutions within a fixed SRAM budget
+//
+//  Every tier is a ring of its own, so each keeps its full span whatever the
+//  signal does. The quarter and hour aggregates are built from running sums,
+//  so a sample costs the same whether a tier rolls over or not.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include "history.h"
+
+#define SAMPLES_PER_QUARTER 15
+#define SAMPLES_PER_HOUR    60
+#define SPREAD_MAX          15               // one nibble
+
+typedef struct
+{
+  unsigned char Avg;                         // 0.5 deg C steps from -40 deg C
+  unsigned char Spread;                      // high nibble avg - min, low nibble max - avg
+} History_Aggregate;
+
+typedef struct
+{
+  unsigned int Sum;                          // max. 60 * 255
+  unsigned char Min;
+  unsigned char Max;
+} History_Acc;
+
+typedef struct
+{
+  unsigned char Minute[HISTORY_MINUTES][HISTORY_SENSORS]; // History_Pack() format
+  History_Aggregate Quarter[HISTORY_QUARTERS][HISTORY_SENSORS];
+  History_Aggregate Hour[HISTORY_HOURS][HISTORY_SENSORS];
+  History_Acc QuarterAcc[HISTORY_SENSORS];
+  History_Acc HourAcc[HISTORY_SENSORS];
+  unsigned char MinuteHead;                  // next write position
+  unsigned char MinuteCount;                 // valid minutes
+  unsigned char QuarterHead;
+  unsigned char QuarterCount;
+  unsigned char HourHead;
+  unsigned char HourCount;
+  unsigned char QuarterFill;                 // samples in QuarterAcc
+  unsigned char HourFill;                    // samples in HourAcc
+} History_Store;
+
+// compile time check of the SRAM budget
+typedef char History_Budget_Check[sizeof (History_Store) <= HISTORY_BUDGET ? 1 : -1];
+
+static History_Store History;
+unsigned long History_Samples = 0;
+
+unsigned char History_Pack(int value)
+{
+  if (value <= -400)
+    return 0;
+  if (value >= 875)
+    return 255;
+  return (value + 402) / 5;                  // rounded to 0.5 deg C
+}
+
+int History_Unpack(unsigned char raw)
+{
+  return raw * 5 - 400;
+}
+
+static void History_Accumulate(History_Acc *acc, unsigned char fill, unsigned char raw)
+{
+  if (fill == 0)
+  {
+    acc->Sum = raw;
+    acc->Min = raw;
+    acc->Max = raw;
+    return;
+  }
+  acc->Sum += raw;
+  if (raw < acc->Min)
+    acc->Min = raw;
+  if (raw > acc->Max)
+    acc->Max = raw;
+}
+
+static void History_Close(History_Aggregate *a, const History_Acc *acc, unsigned char samples)
+{
+  unsigned char avg = (acc->Sum + samples / 2) / samples;
+  unsigned char lo = avg - acc->Min;
+  unsigned char hi = acc->Max - avg;
+
+  if (lo > SPREAD_MAX)
+    lo = SPREAD_MAX;
+  if (hi > SPREAD_MAX)
+    hi = SPREAD_MAX;
+  a->Avg = avg;
+  a->Spread = (lo << 4) | hi;
+}
+
+static void History_Point_Set(History_Point *p, unsigned char min, unsigned char avg, unsigned char max)
+{
+  p->Min = History_Unpack(min);
+  p->Avg = History_Unpack(avg);
+  p->Max = History_Unpack(max);
+}
+
+// position of entry i in a ring, 0 = oldest
+static unsigned char History_Slot(unsigned char head, unsigned char count,
+                                  unsigned char size, unsigned int i)
+{
+  unsigned int pos = head + size - count + i;
+
+  return pos >= size ? pos - size : pos;
+}
+
+void History_Add(const int *values)
+{
+  unsigned char s, raw;
+
+  for (s = 0; s < HISTORY_SENSORS; s++)
+  {
+    raw = History_Pack(values[s]);
+    History.Minute[History.MinuteHead][s] = raw;
+    History_Accumulate(&History.QuarterAcc[s], History.QuarterFill, raw);
+    History_Accumulate(&History.HourAcc[s], History.HourFill, raw);
+  }
+  History_Samples++;
+
+  if (++History.MinuteHead == HISTORY_MINUTES)
+    History.MinuteHead = 0;
+  if (History.MinuteCount < HISTORY_MINUTES)
+    History.MinuteCount++;
+
+  if (++History.QuarterFill == SAMPLES_PER_QUARTER)
+  {
+    History.QuarterFill = 0;
+    for (s = 0; s < HISTORY_SENSORS; s++)
+      History_Close(&History.Quarter[History.QuarterHead][s], &History.QuarterAcc[s], SAMPLES_PER_QUARTER);
+    if (++History.QuarterHead == HISTORY_QUARTERS)
+      History.QuarterHead = 0;
+    if (History.QuarterCount < HISTORY_QUARTERS)
+      History.QuarterCount++;
+  }
+  if (++History.HourFill == SAMPLES_PER_HOUR)
+  {
+    History.HourFill = 0;
+    for (s = 0; s < HISTORY_SENSORS; s++)
+      History_Close(&History.Hour[History.HourHead][s], &History.HourAcc[s], SAMPLES_PER_HOUR);
+    if (++History.HourHead == HISTORY_HOURS)
+      History.HourHead = 0;
+    if (History.HourCount < HISTORY_HOURS)
+      History.HourCount++;
+  }
+}
+
+unsigned int History_Count(unsigned char tier)
+{
+  if (tier == HISTORY_MINUTE)
+    return History.MinuteCount;
+  if (tier == HISTORY_QUARTER)
+    return History.QuarterCount;
+  return History.HourCount;
+}
+
+void History_Get(unsigned char tier, unsigned char sensor, unsigned int i, History_Point *p)
+{
+  const History_Aggregate *a;
+  unsigned char raw;
+
+  if (tier == HISTORY_MINUTE)
+  {
+    raw = History.Minute[History_Slot(History.MinuteHead, History.MinuteCount, HISTORY_MINUTES, i)][sensor];
+    History_Point_Set(p, raw, raw, raw);
+    return;
+  }
+  if (tier == HISTORY_QUARTER)
+    a = &History.Quarter[History_Slot(History.QuarterHead, History.QuarterCount, HISTORY_QUARTERS, i)][sensor];
+  else
+    a = &History.Hour[History_Slot(History.HourHead, History.HourCount, HISTORY_HOURS, i)][sensor];
+  History_Point_Set(p, a->Avg - (a->Spread >> 4), a->Avg, a->Avg + (a->Spread & 0x0F));
+}
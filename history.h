@@ -0,0 +1,52 @@
+/*
+history.h - Sensor history in three resolutions within a fixed SRAM budget
+
+  HISTORY_MINUTE   1 minute values of the last HISTORY_MINUTES minutes
+  HISTORY_QUARTER  15 minute min/avg/max of the last day
+  HISTORY_HOUR     hourly min/avg/max of the last week
+
+History_Add() is called once a minute with one value per sensor and
+updates all tiers in constant time. Values are stored in 0.5 deg C steps
+from -40 deg C, one byte each. Every tier has a ring of its own, so the
+spans hold for any signal; the minute ring gets what the budget leaves.
+
+Quarter and hour min and max are kept as offset to the average in one
+nibble each (saturating at 7.5 deg C). The size of the store is checked
+against HISTORY_BUDGET at compile time. History_Add() and the readers run
+in the main loop only, there is no locking.
+
+*/
+
+#ifndef _history_h
+#define _history_h
+
+#define HISTORY_SENSORS  2                   // internal sensor, NTC
+#define HISTORY_MINUTES  90                  // at least the hour of the chart
+#define HISTORY_QUARTERS 96
+#define HISTORY_HOURS    168
+#define HISTORY_BUDGET   1280                // bytes of SRAM
+
+// Tiers
+#define HISTORY_MINUTE  0
+#define HISTORY_QUARTER 1
+#define HISTORY_HOUR    2
+
+typedef struct
+{
+  int Min;                                   // all in 0.1 deg C
+  int Avg;
+  int Max;
+} History_Point;
+
+void History_Add(const int *values);         // HISTORY_SENSORS values in 0.1 deg C
+unsigned int History_Count(unsigned char tier);
+// entry i of a tier, 0 = oldest, History_Count() - 1 = latest
+void History_Get(unsigned char tier, unsigned char sensor, unsigned int i, History_Point *p);
+
+// one byte storage format, 0.5 deg C steps from -40 deg C to +87.5 deg C
+unsigned char History_Pack(int value);
+int History_Unpack(unsigned char raw);
+
+extern unsigned long History_Samples;        // History_Add() calls since start
+
+#endif /* _history_h */
@@ -0,0 +1,123 @@
+//******************************************************************************
+//  http.c - HTTP/1.1 response header and chunked streaming
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "uart_tx.h"
+#include "format.h"
+#include "http.h"
+
+// Http_Mode
+#define HTTP_HEAD    0x01                    // headers only
+#define HTTP_10      0x02                    // no chunks
+#define HTTP_CHUNKED 0x04                    // chunked body open
+#define HTTP_CLOSE   0x08                    // "Connection: close"
+
+static unsigned char Http_Mode = 0;
+
+void Http_Begin(const Request *r)
+{
+  Http_Mode = 0;
+  if (r && r->Method == REQUEST_HEAD)
+    Http_Mode |= HTTP_HEAD;
+  if (r && (r->Flags & REQUEST_HTTP10))
+    Http_Mode |= HTTP_10;
+  if (r && (r->Flags & REQUEST_CLOSE))
+    Http_Mode |= HTTP_CLOSE;
+}
+
+static void Http_Connection(void)
+{
+  if (Http_Mode & HTTP_CLOSE)
+    printfln("Connection: close");
+}
+
+void Http_End(void)
+{
+  Http_EndChunked();
+  UartTx_Discard(0);
+  Http_Mode = 0;
+}
+
+void Http_Body(void)
+{
+  printfln("");
+  if (Http_Mode & HTTP_HEAD)
+    UartTx_Discard(1);
+}
+
+void Http_Header(const char *contentType)
+{
+  printfln("HTTP/1.1 200 OK");
+  Http_Connection();
+  printf("Content-Type: ");
+  printfln(contentType);
+}
+
+void Http_Error(const char *status)
+{
+  printf("HTTP/1.1 ");
+  printfln(status);
+  Http_Connection();
+  printfln("Content-Length: 0");
+  printfln("");
+}
+
+void Http_BeginChunked(const char *contentType)
+{
+  if (Http_Mode & HTTP_10)
+    Http_Mode |= HTTP_CLOSE;                 // body ends with the connection
+  Http_Header(contentType);
+  if (!(Http_Mode & HTTP_10))
+    printfln("Transfer-Encoding: chunked");
+  Http_Body();
+  if (!(Http_Mode & (HTTP_10 | HTTP_HEAD)))
+  {
+    Http_Mode |= HTTP_CHUNKED;
+    UartTx_BeginChunked();
+  }
+}
+
+void Http_EndChunked(void)
+{
+  if (Http_Mode & HTTP_CHUNKED)
+  {
+    Http_Mode &= ~HTTP_CHUNKED;
+    UartTx_EndChunked();
+  }
+}
+
+static unsigned char Http_Match(const char *a, const char *b)
+{
+  while (*a && *a == *b)
+  {
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+void Http_Static(const Request *r, const char *contentType, const char *etag,
+                 const char *body, unsigned int length)
+{
+  if ((r->Flags & REQUEST_ETAG) && Http_Match(r->ETag, etag))
+  {
+    printfln("HTTP/1.1 304 Not Modified");
+    Http_Connection();
+    printf("ETag: ");
+    printfln(etag);
+    printfln("");
+    return;
+  }
+  Http_Header(contentType);
+  printf("ETag: ");
+  printfln(etag);
+  printf("Content-Length: ");
+  Format_Unsigned(length);
+  printfln("");
+  Http_Body();
+  if (!(Http_Mode & HTTP_HEAD))
+    printf(body);
+}
@@ -0,0 +1,38 @@
+/*
+http.h - HTTP/1.1 response header and chunked streaming
+
+Pages whose length is unknown are sent between Http_BeginChunked() and
+Http_EndChunked(), everything printed in between with printf()/printfln()
+is framed as chunks. So the connection can stay open and the browser can
+start parsing before the page is complete.
+
+Http_Static() sends a page that never changes with an ETag, or only
+"304 Not Modified" when the browser already has it.
+
+A response is framed by Http_Begin() and Http_End() (Route_Dispatch()
+does that). When the request asked for it (HTTP/1.0 without keep-alive,
+"Connection: close") every response carries "Connection: close", so
+the browser closes its side and doesn't wait for the ME9210 to time the
+connection out. HTTP/1.0 clients don't know chunks: Http_BeginChunked()
+answers them with "Connection: close" and a plain body that ends with the
+connection. For HEAD only the headers are sent, Http_Body() ends them and
+drops the body that follows.
+
+*/
+
+#ifndef _http_h
+#define _http_h
+
+#include "request.h"
+
+void Http_Begin(const Request *r);          // response to 'r', 0 = HTTP/1.1 GET
+void Http_End(void);
+void Http_Header(const char *contentType);   // status line and Content-Type
+void Http_Body(void);                        // empty line, body follows
+void Http_Error(const char *status);        // e.g. "404 Not Found", empty body
+void Http_BeginChunked(const char *contentType);
+void Http_EndChunked(void);
+void Http_Static(const Request *r, const char *contentType, const char *etag,
+                 const char *body, unsigned int length);
+
+#endif /* _http_h */
@@ -3,7 +3,7 @@
 //
 //  Description: UART0 communicates continously as fast as possible full-duplex
 //  with another device. Normal mode is LPM3, with activity only during RX and
-//  TX or WDT ISR's. The TX ISR indicates the UART is ready to send another character.
+//  TX or Timer_A ISR's. The TX ISR indicates the UART is ready to send another character.
 //  The RX ISR indicates the UART has received a character. At 9600 baud, a full
 //  character is tranceived ~1ms.
 //  RX ISR is displayed on P1.5
@@ -34,276 +34,156 @@
 // Use: http://192.168.0.102:2101/login.htm
 
 #include <msp430x14x.h>
-
-// Define flags used by the interrupt routines
-#define TX BIT0
+#include "uart_tx.h"
+#include "ntc.h"
+#include "adc.h"
+#include "format.h"
+#include "csv.h"
+#include "upload.h"
+#include "event.h"
+#include "alarm.h"
+
+// Events, in order of priority
+#define EVENT_SAMPLE 0                       // posted by Timer_A alarms
+#define EVENT_LED    1
+#define EVENT_UPLOAD 2
+#define EVENT_CLOCK  3                       // posted by the RX ISR
+
+// Timer_A alarms
+#define ALARM_SAMPLE 0
+#define ALARM_LED    1
 #define API_KEY "t5oM-cXVCGkP-Rbb3m8xa8Avwc-SAKxJV0l1bVUvaEdoTT0g" // your Cosm API key
 #define FEED_ID "116164" // Cosm feed ID
 #define USER_AGENT "Datalogger_One"
-#define TEMP_MIN_TEMP -40
-#define TEMP_MAX_TEMP 79
-#define TEMP_TABLE_SIZE 120
-
-// Flag register
-volatile unsigned char FLAGS = 0;
+#define SAMPLE_MINUTES 5                     // sample interval, upload see UPLOAD_INTERVAL
+#define ALARM_TEMP 600                       // 0.1 deg C, NTC values from here are sent at once
+#define LED_SECONDS 60                       // P2.2 flashes once per interval
+#define LED_FLASH (ALARM_HZ / 32)            // ticks
 
-char buffer[4];
 //char RXBuffer[15];
-char IntDegC;
+int IntDegC;                                 // deg C, signed
 //char TempValues[60];
-long index;
 //char hour=10;
 //char minute=0;
-int second=0;
-int position=0;
-
-static const unsigned int Temperature_Lookup[] = {
-  0x3E9, 0x3E7, 0x3E5, 0x3E4, 0x3E2, 0x3DF, 0x3DD, 0x3DB, 0x3D8, 0x3D6, 0x3D3,
-  0x3D0, 0x3CD, 0x3C9, 0x3C6, 0x3C2, 0x3BE, 0x3BA, 0x3B6, 0x3B2, 0x3AD, 0x3A8,
-  0x3A3, 0x39D, 0x398, 0x392, 0x38C, 0x385, 0x37F, 0x378, 0x371, 0x36A, 0x362,
-  0x35A, 0x352, 0x34A, 0x341, 0x338, 0x32F, 0x326, 0x31C, 0x312, 0x308, 0x2FE,
-  0x2F4, 0x2E9, 0x2DE, 0x2D3, 0x2C8, 0x2BD, 0x2B1, 0x2A6, 0x29A, 0x28F, 0x283,
-  0x277, 0x26B, 0x25F, 0x253, 0x247, 0x23B, 0x22F, 0x223, 0x217, 0x20B, 0x1FF,
-  0x1F3, 0x1E8, 0x1DC, 0x1D1, 0x1C5, 0x1BA, 0x1AF, 0x1A4, 0x199, 0x18F, 0x184,
-  0x17A, 0x170, 0x166, 0x15C, 0x153, 0x14A, 0x140, 0x137, 0x12F, 0x126, 0x11E,
-  0x116, 0x10E, 0x106, 0x0FE, 0x0F7, 0x0F0, 0x0E9, 0x0E2, 0x0DB, 0x0D5, 0x0CF,
-  0x0C9, 0x0C3, 0x0BD, 0x0B7, 0x0B2, 0x0AD, 0x0A8, 0x0A3, 0x09E, 0x099, 0x095,
-  0x090, 0x08C, 0x088, 0x084, 0x080, 0x07C, 0x079, 0x075, 0x072, 0x06E, 0x06B
-   };
+unsigned long minute=0;                    // since start, from Alarm_Seconds()
+Csv_Stamp Now;                             // date and time of 'minute', once Synced
+unsigned char Synced = 0;                  // Now is set from the Date: of Cosm
+unsigned long SampleAt;                    // ticks of the next sample
+unsigned long LedAt;                       // ticks of the next LED flash
+
+// datastream 0: internal sensor in deg C, 1: NTC in 0.1 deg C
+const Cosm_Stream Streams[UPLOAD_STREAMS] = { { "0", 0 }, { "1", 1 } };
+const Cosm_Feed Feed = { FEED_ID, API_KEY, USER_AGENT, Streams, UPLOAD_STREAMS };
+// deadband, rate per sample, min. and max. minutes between values
+const Upload_Policy Policies[UPLOAD_STREAMS] = { { 2, 3, 30, 240 }, { 10, 15, 30, 240 } };
+
+// returns temperature of channel 10 from the last Adc_Sample() sequence
+// (MSP430's internal temperature reference diode)
+// in deg C, signed: plain char is unsigned in this project (CCCharIs=1)
+// NOTE: to get a more exact value, 8-times oversampling is used
 
-signed char Temperature_GetTemperature(unsigned int Temp_ADC)
+int GetTempVal(void)
 {
-	if (Temp_ADC > Temperature_Lookup[0])
-	  return TEMP_MIN_TEMP;
+  long ReturnValue;
 
-	for (char Index = 0; Index < TEMP_TABLE_SIZE; Index++)
-	{
-		if (Temp_ADC > Temperature_Lookup[Index])
-		  return (Index + TEMP_MIN_TEMP);
-	}
+  ReturnValue = Adc_GetAverage(ADC_CH_INTERNAL);
+  
+  ReturnValue = (ReturnValue - 2692) * 423;
+  ReturnValue = ReturnValue / 4096;
 
-	return TEMP_MAX_TEMP;
+  return ReturnValue;
 }
 
-/**
-* Sends a single byte out through UART
-**/
-void sendByte(unsigned char byte )
-  {
-  while (!(IFG1 & UTXIFG0)); // USART0 TX buffer ready?
-  TXBUF0 = byte;             // send character
-  }
-
-void putc(unsigned b)
-  {
-  sendByte(b);
-  }
-
-void printf(char *s)
-  {
-  char c;
-  
-  // Loops through each character in string 's'
-  while (c = *s++) {
-  sendByte(c);
-  }
-  }
+// returns temperature of channel 0 from the last Adc_Sample() sequence
+// external NTC on channel 0, result in 0.1 deg C
+int GetTempVal2(void)
+{
+  return Temperature_GetDeciDegrees (Adc_GetAverage(ADC_CH_NTC)); // calculate temperature, external NTC
+}
 
-void printfln(char *s)          //send with \r\n
-  {
-  char c;
-  
-  // Loops through each character in string 's'
-  while (c = *s++) {
-  sendByte(c);
-  }
-  printf("\r\n");
-  }
+// Brings 'minute' and its date up to the clock of Timer_A
+void UpdateClock(void)
+{
+  unsigned long m = Alarm_Seconds() / 60;
 
-int ltoa_format (char *erg, long zahl, unsigned int vk, unsigned int nk)
-{ // Out-String, input long, pre-decimal digits, decimal digits, sign '+' or ' ' 
-  char vorz = ' '; 
-  long temp;
-   int  i;
-   i = vk + nk + 1;                   	// string length 
-   erg[i--] = 0;                      	// string end
-   if ( zahl == 0 )						// special case input = 0  
-   {
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) >= vk) ) // vk contain sign
-	   	{
-	      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed
-	      else erg[i--] = '0'; // detach digit, value = 0
-	  	}
-      if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-    } 
-   else 
-   {
-      if ( zahl < 0 )
-      {
-      vorz  = '-';                     // sign = '-'
-      zahl *=  -1;                     // calculate further with positive value
-      }
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) > vk) ) // vk contain sign  
-      {
-      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed  
-      else 
-      {
-      temp     =  zahl / 10;           	// integer division  
-      erg[i--] = (zahl - temp*10) + 48; // detach digit, assign ASCII-value
-      zahl     =  temp;                	// for next pass reduce digit
-      }
-   	  }
-   if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-   }
-   while( i >= 0 ) erg[i--] = ' ';     	// fill begin with spaces
-   return  vk + nk + 1;                	// return string length
+  if (Synced)
+    Csv_Forward(&Now, (unsigned int)(m - minute));
+  minute = m;
 }
 
-// samples and returns AD-converter value of channel 10
-// (MSP430's internal temperature reference diode)
-// NOTE: to get a more exact value, 8-times oversampling is used
-
-char GetTempVal(void)
+// Sets the clock from the Date: header of a Cosm reply, to the minute
+void Task_Clock(void)
 {
-  unsigned long ReturnValue;
+  Csv_Stamp t;
 
-  ADC12CTL0 = ADC12ON | SHT0_15 | MSH | REFON;   // ADC on, int. ref. on (1,5 V),
-                                                 // multiple sample & conversion
-  ADC12CTL1 = ADC12SSEL_2 | ADC12DIV_7 | CSTARTADD_0 | CONSEQ_1 | SHP;   // MCLK / 8 = 1 MHz
+  if (!Cosm_Date(&t))
+    return;
+  UpdateClock();
+  Now = t;
+  Synced = 1;
+}
 
-  ADC12MCTL0 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL1 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL2 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL3 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL4 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL5 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL6 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL7 = EOS | SREF_1 | INCH_10;           // int. ref., channel 10, last seg.
-  
-  ADC12CTL0 |= ENC;                              // enable conversion
-  ADC12CTL0 |= ADC12SC;                          // sample & convert
-  
-  while (ADC12CTL0 & ADC12SC);                   // wait until conversion is complete
-  
-  ADC12CTL0 &= ~ENC;                             // disable conversion
+void Task_Sample(void)
+{
+  int values[UPLOAD_STREAMS];
 
-  ReturnValue = ADC12MEM0;                       // sum up values...
-  ReturnValue += ADC12MEM1;
-  ReturnValue += ADC12MEM2;
-  ReturnValue += ADC12MEM3;
-  ReturnValue += ADC12MEM4;
-  ReturnValue += ADC12MEM5;
-  ReturnValue += ADC12MEM6;
-  ReturnValue += ADC12MEM7;
+  SampleAt += ALARM_TICKS(SAMPLE_MINUTES * 60);  // no drift, the interval is fixed
+  Alarm_Set(ALARM_SAMPLE, SampleAt, EVENT_SAMPLE);
+  UpdateClock();
 
-  ReturnValue >>= 3;                             // ... and divide by 8
-  
-  ReturnValue = (ReturnValue - 2692) * 423;
-  ReturnValue = ReturnValue / 4096;
+  Adc_Sample();                          // convert both sensors in one sequence
+  IntDegC = GetTempVal();                // Get Temperature Value internal sensor
+  values[0] = IntDegC;
+  values[1] = GetTempVal2();             // Get Temperature Value external NTC
 
-  return ReturnValue;
+  if (Upload_Add(Policies, minute, values, values[1] >= ALARM_TEMP))
+    Event_Post(EVENT_UPLOAD);
 }
 
-// samples and returns AD-converter value of channel 0
-// external NTC on channel 0
-char GetTempVal2(void)
+// Short flash of P2.2, two wake-ups per LED_SECONDS
+void Task_Led(void)
 {
-  unsigned long temp;
+  P2OUT ^= 0x04;                            // Toggle P2.2 
+  if (P2OUT & 0x04)
+    Alarm_Set(ALARM_LED, Alarm_Now() + LED_FLASH, EVENT_LED);
+  else
+  {
+    LedAt += ALARM_TICKS(LED_SECONDS);
+    Alarm_Set(ALARM_LED, LedAt, EVENT_LED);
+  }
+}
 
-  ADC12CTL0 = ADC12ON | SHT0_15 | MSH;   // ADC on, int. ref. off,
-                                                 // multiple sample & conversion
-  ADC12CTL1 = ADC12SSEL_2 | ADC12DIV_7 | CSTARTADD_0 | CONSEQ_1 | SHP;   // MCLK / 8 = 1 MHz
+// Lowest priority, samples due meanwhile are taken afterwards
+void Task_Upload(void)
+{
+  P3OUT |= 0x01;                           // activate ME9210
+  P1OUT |= 0x20;
 
-  ADC12MCTL0 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL1 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL2 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL3 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL4 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL5 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL6 = SREF_0 | INCH_0;                 // int. ref., channel 0
-  ADC12MCTL7 = EOS | SREF_0 | INCH_0;           // int. ref., channel 0, last seg.
-  
-  ADC12CTL0 |= ENC;                              // enable conversion
-  ADC12CTL0 |= ADC12SC;                          // sample & convert
-  
-  while (ADC12CTL0 & ADC12SC);                   // wait until conversion is complete
-  
-  ADC12CTL0 &= ~ENC;                             // disable conversion
+  //for (index = 0; index < 500000; index++);  // delay
 
-  temp = ADC12MEM0;                       // sum up values...
-  temp += ADC12MEM1;
-  temp += ADC12MEM2;
-  temp += ADC12MEM3;
-  temp += ADC12MEM4;
-  temp += ADC12MEM5;
-  temp += ADC12MEM6;
-  temp += ADC12MEM7;
+  P1OUT &= ~0x20;
+  Upload_Send(&Feed, Synced ? &Now : 0, minute);  // one PUT for all queued samples,
+                                           // no time stamps before the first reply
 
-  temp >>= 5;                             // ... and divide by 32
-  
-  
-  return Temperature_GetTemperature (temp); // calculate temperature, external NTC
+  //for (index = 0; index < 200000; index++);  // delay
+  //P3OUT &= ~0x01;                         // deactivate ME9210
 }
 
-// Watchdog Timer interrupt service routine
-#pragma vector=WDT_VECTOR
-__interrupt void watchdog_timer(void)
+static const Event_Task Tasks[] = { Task_Sample, Task_Led, Task_Upload, Task_Clock };
+
+#pragma vector=USART0RX_VECTOR
+__interrupt void usart0_rx (void)
 {
-  P2OUT ^= 0x04;                            // Toggle P2.2 
-    
-  second++;
-  
-  if (second == 300) 
+  if (Cosm_Receive(RXBUF0))                 // reply of Cosm, Date: read
   {
-    second = 0;
-    
-    P3OUT |= 0x01;                           // activate ME9210
-    P1OUT |= 0x20;
-    
-    //for (index = 0; index < 500000; index++);  // delay
-    
-    P1OUT &= ~0x20;
-                
-    printf("PUT /v2/feeds/");
-    printf(FEED_ID);
-    printfln(".csv HTTP/1.1");
-    printfln("Host: api.cosm.com");
-    printf("X-ApiKey: ");
-    printfln(API_KEY);
-    printf("User-Agent: ");
-    printfln(USER_AGENT);
-    
-    printfln("Content-Length: 11");
-    printfln("Content-Type: text/csv");
-    printfln("Connection: close");
-    printfln("");
-
-    // here's the actual content of the PUT request:
-    IntDegC = GetTempVal();              // Get Temperature Value internal sensor
-    ltoa_format(buffer, IntDegC, 2,0);
-    
-    printf("0,");
-    printf(buffer);
-    
-    IntDegC = GetTempVal2();              // Get Temperature Value external NTC
-    ltoa_format(buffer, IntDegC, 2,0);
-    
-    printf("\n1,");
-    printfln(buffer);
-    
-    //for (index = 0; index < 200000; index++);  // delay
-    //P3OUT &= ~0x01;                         // deactivate ME9210
-    _BIS_SR(LPM3_bits + GIE);                // Enter LPM3 w/ interrupt
+    Event_Post(EVENT_CLOCK);
+    _BIC_SR_IRQ(LPM3_bits);                 // Clear LPM3 bits from 0(SR)
   }
- }
-
+}
 
 void main(void)
 {
-  //WDTCTL = WDTPW + WDTHOLD;                 // Stop WDT
-  WDTCTL = WDT_ADLY_1000;                    // WDT 1000ms, ACLK, interval timer
+  WDTCTL = WDTPW + WDTHOLD;                 // Stop WDT, Timer_A wakes up
   
   P1OUT = 0x00;                             // P1.5 setup for LED output
   P1DIR = 0x20;
@@ -317,19 +197,21 @@ void main(void)
   P6OUT = 0;
   P6DIR = 0x00;                             // all input
         
-  ME1 |= UTXE0;                             // Enable USART0 TXD
+  ME1 |= UTXE0 + URXE0;                     // Enable USART0 TXD/RXD
   UCTL0 |= CHAR;                            // 8-bit character
   UTCTL0 |= SSEL0;                          // UCLK = ACLK
   UBR00 = 0x03;                             // 32768/9600 = 3.41, set 3
   UBR10 = 0x00;                             // according to MSP430 User's guide table 13-2
   UMCTL0 = 0x4a;                            // Modulation
   UCTL0 &= ~SWRST;                          // Initialize USART state machine
-  IE1 |= WDTIE;                             // Enable WDT interrupt
+  IE1 |= URXIE0;                            // Enable USART0 RX interrupt, replies of Cosm
   IFG1 &= ~UTXIFG1;                         // initales interrupt-flag loeschen
-   _BIS_SR(LPM3_bits + GIE);                // Enter LPM3 w/ interrupt
-  
-  while(1)
-  {
-    
-  }
+
+  Alarm_Init();                             // Timer_A on ACLK, minute 0
+  SampleAt = ALARM_TICKS(SAMPLE_MINUTES * 60);
+  Alarm_Set(ALARM_SAMPLE, SampleAt, EVENT_SAMPLE);
+  LedAt = ALARM_TICKS(LED_SECONDS);
+  Alarm_Set(ALARM_LED, LedAt, EVENT_LED);
+
+  Event_Run(Tasks, sizeof Tasks / sizeof Tasks[0]);  // sleeps in LPM3 between events
  }
\ No newline at end of file
@@ -35,22 +35,19 @@
 //******************************************************************************
 
 #include <msp430x14x.h>
+#include "uart_tx.h"
+#include "adc.h"
+#include "request.h"
+#include "http.h"
 #include "webside.h"
 
-static char string1[8];
-char string2[]="HTTP/1.1 200 OK\r\n";
-char string3[]="Connection: Close\r\n";
-char string4[]="Content-Type: text/html\r\n";
-char string5[]="Content-Length:150\r\n\r\n\r\n";
-char string6[]="<HTML>\r\n";
-char string7[]="<BODY>\r\n";
-char string8[]="<H2>Webserver mit DigiConnect von Kai</H2>\r\n";
-char string9[]="<p>Website von MSP430 erzeugt...</p>\r\n";
-char string10[]="</BODY>\r\n";
-char string11[]="</HTML>\r\n";
+// Define flags used by the interrupt routines
+#define TX BIT0
 
-char m, j, k, l, n, p, o, q, r;
-int i;
+// Flag register
+volatile unsigned char FLAGS = 0;
+
+int Values[2];                              // slots of the WebSide template
 
 void main(void)
 {
@@ -59,6 +56,7 @@ void main(void)
   P1DIR = 0x20;
  // P2DIR |= 0x04;                            // Set P2.2 to output direction
   P3SEL |= 0x30;                            // P3.4,5 = USART0 TXD/RXD
+  P6SEL = 0x01;                             // use P6.0 for the ADC module
   ME1 |= UTXE0 + URXE0;                     // Enable USART0 TXD/RXD
   UCTL0 |= CHAR;                            // 8-bit character
   UTCTL0 |= SSEL0;                          // UCLK = ACLK
@@ -66,68 +64,40 @@ void main(void)
   UBR10 = 0x00;                             //
   UMCTL0 = 0x4a;                            // Modulation
   UCTL0 &= ~SWRST;                          // Initialize USART state machine
-  IE1 |= URXIE0 +  UTXIE0;                  // Enable USART0 RX/TX interrupt
+  IE1 |= URXIE0;                            // Enable USART0 RX interrupt, TX ISR is
+                                            // enabled by sendByte()
   IFG1 &= ~UTXIFG1;  // initales interrupt-flag loeschen
-  _BIS_SR(LPM3_bits + GIE);                 // Enter LPM3 w/ interrupt
   
+  while(1)
+  {
+    switch(FLAGS)
+    {
+        case 0: // No flags set
+        _BIS_SR(LPM3_bits + GIE); // Enter LPM3
+        break;
+        case TX: // Page needs to be transmitted
+        FLAGS &= ~TX;
+        if (Request_Get() == 0)                 // one response per request
+          break;
+        Http_Begin(Request_Get());
+        Adc_Sample();
+        Values[0] = ((unsigned long)Adc_GetAverage(ADC_CH_NTC) * 100) >> 12;      // % of AVcc
+        Values[1] = ((unsigned long)Adc_GetAverage(ADC_CH_INTERNAL) * 100) >> 12; // % of 1,5 V
+        Template_Send(&WebSide, Values);
+        Http_End();
+        Request_Release();
+        FLAGS |= TX;                            // look for further requests
+        break;
+    }
+  }
  }
 
 #pragma vector=USART0RX_VECTOR
 __interrupt void usart0_rx (void)
 {
-//  string1[j++] = RXBUF0;
-//  if (j > sizeof string1-1)
-//  {
-//    i = 0;
-//    j = 0;
-//    TXBUF0  = string1[i++];
-//  }
-//  P1OUT = RXBUF0 << 4;                           // RXBUF0 to TXBUF0
-  string1[0] = RXBUF0;
-  P1OUT ^= 0x20;
-  
-  if (string1[0] == 'G')
+  if (Request_Byte(RXBUF0))                 // request complete?
   {
-    i = 0;
- /*   j = 0;
-    k = 0;
-    l = 0;
-    m = 0;
-    n = 0;
-    p = 0;
-    q = 0;
-    o = 0;
-    r = 0;*/
-   // TXBUF0  = string2[i++];
-   TXBUF0  = WebSide[i++]; 
+    FLAGS |= TX;                            // Set flag to transmit data
+    _BIC_SR_IRQ(LPM3_bits);                 // Clear LPM3 bits from 0(SR)
   }
-   
-}
-
-#pragma vector=USART0TX_VECTOR
-__interrupt void usart0_tx (void)
-{
- /* if (i < sizeof string2-1)
-    TXBUF0  = string2[i++];                             // Transmit string
-  else if (j < sizeof string3-1)
-    TXBUF0  = string3[j++];                             // Transmit string
-  else if (k < sizeof string4-1)
-    TXBUF0  = string4[k++];                             // Transmit string   
-  else if (l < sizeof string5-1)
-    TXBUF0  = string5[l++];                             // Transmit string  
-  else if (m < sizeof string6-1)
-    TXBUF0  = string6[m++];                             // Transmit string  
-  else if (n < sizeof string7-1)
-    TXBUF0  = string7[n++];                             // Transmit string  
-  else if (o < sizeof string8-1)
-    TXBUF0  = string8[o++];                             // Transmit string  
-  else if (p < sizeof string9-1)
-    TXBUF0  = string9[p++];                             // Transmit string  
-  else if (q < sizeof string10-1)
-    TXBUF0  = string10[q++];                             // Transmit string  
-   else if (r < sizeof string11-1)
-    TXBUF0  = string11[r++];                             // Transmit string  
-  */
-   if (i < sizeof WebSide-1)
-    TXBUF0  = WebSide[i++];                             // Transmit string
 }
@@ -34,177 +34,37 @@
 // Use: http://192.168.0.102:2101/login.htm
 
 #include <msp430x14x.h>
+#include "uart_tx.h"
+#include "http.h"
+#include "request.h"
+#include "route.h"
+#include "pages.h"
+#include "flashlog.h"
 
 //#include "webside.h"
 
 // Define flags used by the interrupt routines
 #define TX BIT0
+#define SAMPLE BIT1                          // a minute is over
 
 // Flag register
 volatile unsigned char FLAGS = 0;
 
-char buffer[4];
-char RXBuffer[15];
-char IntDegC;
-char TempValues[60];
-char index;
-char hour=10;
-char minute=0;
-char second=0;
-int position=0;
+Request *Req;
 
-
-/**
-* Sends a single byte out through UART
-**/
-void sendByte(unsigned char byte )
-  {
-  while (!(IFG1 & UTXIFG0)); // USART0 TX buffer ready?
-  TXBUF0 = byte;             // send character
-  }
-
-void putc(unsigned b)
-  {
-  sendByte(b);
-  }
-
-void printf(char *s)
-  {
-  char c;
-  
-  // Loops through each character in string 's'
-  while (c = *s++) {
-  sendByte(c);
-  }
-  }
-
-void printfln(char *s)          //send with \r\n
-  {
-  char c;
-  
-  // Loops through each character in string 's'
-  while (c = *s++) {
-  sendByte(c);
-  }
-  printf("\r\n");
-  }
-
-int ltoa_format (char *erg, long zahl, unsigned int vk, unsigned int nk)
-{ // Out-String, input long, pre-decimal digits, decimal digits, sign '+' or ' ' 
-  char vorz = '0'; 
-  long temp;
-   int  i;
-   i = vk + nk + 1;                   	// string length 
-   erg[i--] = 0;                      	// string end
-   if ( zahl == 0 )						// special case input = 0  
-   {
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) >= vk) ) // vk contain sign
-	   	{
-	      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed
-	      else erg[i--] = '0'; // detach digit, value = 0
-	  	}
-      if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-    } 
-   else 
-   {
-      if ( zahl < 0 )
-      {
-      vorz  = '-';                     // sign = '-'
-      zahl *=  -1;                     // calculate further with positive value
-      }
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) > vk) ) // vk contain sign  
-      {
-      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed  
-      else 
-      {
-      temp     =  zahl / 10;           	// integer division  
-      erg[i--] = (zahl - temp*10) + 48; // detach digit, assign ASCII-value
-      zahl     =  temp;                	// for next pass reduce digit
-      }
-   	  }
-   if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-   }
-   while( i >= 0 ) erg[i--] = ' ';     	// fill begin with spaces
-   return  vk + nk + 1;                	// return string length
-}
-
-// samples and returns AD-converter value of channel 10
-// (MSP430's internal temperature reference diode)
-// NOTE: to get a more exact value, 8-times oversampling is used
-
-char GetTempVal(void)
+// a received byte, from the RX ISR or held back during a flash erase
+void Rx_Byte(unsigned char c)
 {
-  unsigned long ReturnValue;
-
-  ADC12CTL0 = ADC12ON | SHT0_15 | MSH | REFON;   // ADC on, int. ref. on (1,5 V),
-                                                 // multiple sample & conversion
-  ADC12CTL1 = ADC12SSEL_2 | ADC12DIV_7 | CSTARTADD_0 | CONSEQ_1 | SHP;   // MCLK / 8 = 1 MHz
-
-  ADC12MCTL0 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL1 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL2 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL3 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL4 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL5 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL6 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL7 = EOS | SREF_1 | INCH_10;           // int. ref., channel 10, last seg.
-  
-  ADC12CTL0 |= ENC;                              // enable conversion
-  ADC12CTL0 |= ADC12SC;                          // sample & convert
-  
-  while (ADC12CTL0 & ADC12SC);                   // wait until conversion is complete
-  
-  ADC12CTL0 &= ~ENC;                             // disable conversion
-
-  ReturnValue = ADC12MEM0;                       // sum up values...
-  ReturnValue += ADC12MEM1;
-  ReturnValue += ADC12MEM2;
-  ReturnValue += ADC12MEM3;
-  ReturnValue += ADC12MEM4;
-  ReturnValue += ADC12MEM5;
-  ReturnValue += ADC12MEM6;
-  ReturnValue += ADC12MEM7;
-
-  ReturnValue >>= 3;                             // ... and divide by 8
-  
-  ReturnValue = (ReturnValue - 2692) * 423;
-  ReturnValue = ReturnValue / 4096;
-
-  return ReturnValue;
+  if (Request_Byte(c))                         // request complete?
+    FLAGS |= TX;                               // Set flag to transmit data
 }
 
-
-
 #pragma vector=USART0RX_VECTOR
 __interrupt void usart0_rx (void)
 {
-  char r = RXBUF0;
-    
-  RXBuffer[position++] = RXBUF0;                       // reveive 15 characters from UART
-  
-  if (position > sizeof RXBuffer-1)
-  {
-      position = 0;
-      for (char i=0; i<15; i++)
-      {  
-        if (RXBuffer[i] == 'G' & RXBuffer[i+1] == 'E' & RXBuffer[i+2] == 'T')
-           {
-            ME1 &= ~URXE0;                                       // Disable USART0 RXD
-            position = 0;
-            
-            if (RXBuffer[i+8] =='E')
-              P1OUT |= 0x20;
-            if (RXBuffer[i+8] =='A')
-              P1OUT &= ~0x20;
-              
-            FLAGS |= TX;                               // Set flag to transmit data
-            _BIC_SR_IRQ(LPM3_bits);                   // Clear LPM3 bits from 0(SR)
-            _BIC_SR(GIE);
-            }
-        }
-  }
+  Rx_Byte(RXBUF0);
+  if (FLAGS & TX)
+    _BIC_SR_IRQ(LPM3_bits);                   // Clear LPM3 bits from 0(SR)
 }
 
 // Watchdog Timer interrupt service routine
@@ -219,19 +79,84 @@ __interrupt void watchdog_timer(void)
   {
     second = 0;
     minute++;
-    IntDegC = GetTempVal();
-    TempValues[index++] = IntDegC;
+    FLAGS |= SAMPLE;                           // sampled in the main loop, Adc_Sample()
+    _BIC_SR_IRQ(LPM3_bits);                    // sleeps and Page_Status() uses it too
   }
   if (minute == 60)
   {
     minute = 0;
     hour++;
-    index = 0;
   }
-  if (hour==24) hour = 0;
+  if (hour==24)
+  {
+    hour = 0;
+    Csv_Forward(&Today, 24 * 60);            // next day
+  }
     
 }
 
+// /led?3=EIN, answers the LED state as plain text
+void Page_Led(Request *r)
+{
+  Led_Command(r);
+  Http_Header("text/plain");
+  printfln("Content-Length: 3");
+  Http_Body();
+  if (P1OUT & 0x20) printf("EIN");
+  else printf("AUS");
+}
+
+// fills the history from the flash log after a reset. Only the records
+// without a gap up to the last one are used (a dropped batch or a CRC
+// error breaks the chain), so the history stays minute by minute. There
+// is no clock across a reset: the restored minutes are shown as if they
+// ended at the reset, the time the logger was off is not known.
+void History_Restore(void)
+{
+  const FlashLog_Record *rec;
+  unsigned int i, first = FlashLog_Count();
+  unsigned long next = 0;
+  unsigned char k, s;
+
+  while (first > 0)
+  {
+    rec = FlashLog_Get(first - 1);
+    if (rec == 0 || (first < FlashLog_Count() && rec->Minute + rec->Count != next))
+      break;
+    next = rec->Minute;
+    first--;
+  }
+  for (i = first; i < FlashLog_Count(); i++)
+  {
+    rec = FlashLog_Get(i);
+    for (k = 0; k < rec->Count; k++)
+    {
+      for (s = 0; s < HISTORY_SENSORS; s++)
+        Values[s] = History_Unpack(rec->Data[k][s]);
+      History_Add(Values);
+    }
+  }
+}
+
+#define ROUTE_HASH_ROOT   ROUTE_H(ROUTE_SEED, '/')
+#define ROUTE_HASH_LED    ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_HASH_ROOT, 'l'), 'e'), 'd')
+#define ROUTE_HASH_STATUS ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_HASH_ROOT, \
+                            's'), 't'), 'a'), 't'), 'u'), 's')
+#define ROUTE_HASH_DATA   ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_HASH_ROOT, \
+                            'd'), 'a'), 't'), 'a'), '.'), 'c'), 's'), 'v')
+
+ROUTE_CHECK(Route_Check_Led,    ROUTE_HASH_LED,    0);
+ROUTE_CHECK(Route_Check_Data,   ROUTE_HASH_DATA,   1);
+ROUTE_CHECK(Route_Check_Status, ROUTE_HASH_STATUS, 2);
+ROUTE_CHECK(Route_Check_Root,   ROUTE_HASH_ROOT,   3);
+
+const Route Routes[ROUTE_SLOTS] = {
+  { ROUTE_HASH_LED,    Page_Led },          // /led
+  { ROUTE_HASH_DATA,   Page_Data },         // /data.csv
+  { ROUTE_HASH_STATUS, Page_Status },       // /status
+  { ROUTE_HASH_ROOT,   Page_Main }          // /
+};
+
 
 void main(void)
 {
@@ -264,153 +189,32 @@ void main(void)
   IE1 |= URXIE0;                            // Enable USART0 RX/TX interrupt
   IE1 |= WDTIE;                             // Enable WDT interrupt
   IFG1 &= ~UTXIFG1;                         // initales interrupt-flag loeschen
+  FlashLog_Init(Rx_Byte);                   // find the write head of the sample log
+  History_Restore();
    _BIS_SR(LPM3_bits + GIE);                // Enter LPM3 w/ interrupt
   
   while(1)
   {
+    if (FLAGS & SAMPLE)
+    {
+      FLAGS &= ~SAMPLE;
+      Sample();
+      if (FlashLog_Add(Values))
+        FlashLog_Flush();                      // batch full, program it
+    }
     switch(FLAGS)
     {
         case 0: // No flags set
         _BIS_SR(LPM3_bits + GIE); // Enter LPM3
         break;
-        case TX: // Values need to be transmitted
-        //printf (WebSide);
-        //ADC12CTL0 |= ADC12SC;                   // Sampling and conversion start
-        //while (ADC12CTL0 & ADC12BUSY);          // ADC10BUSY?
-        //temp = ADC12MEM0; 
-       // IntDegC = (temp - 2692) * 423;
-       // IntDegC = IntDegC / 4096;
-       
-        IntDegC =   GetTempVal();              // Get Temperature Value
-                 
-        printfln("HTTP/1.1 200 OK");
-        printfln("Connection: Close");
-        printfln("Content-Type: text/html");
-       
-        printfln("");
-        printfln("");
-        printfln("<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.01 Transitional//EN'>");
-        printfln("<html><head>");
-        printfln("<title>MSP430 - Webserver</title>");
-                    
-        printfln("<script type='text/javascript' src='https://www.google.com/jsapi'></script>");
-        printfln("<script type='text/javascript'>");
-        printfln("google.load('visualization', '1', {packages:['corechart']});");
-        printfln("google.setOnLoadCallback(drawChart);");
-        printfln("function drawChart() {\r\n");
-        printfln("var data = google.visualization.arrayToDataTable([");
-        printfln("['Index', 'Temperatur 1'],");
-        // Beispieldaten
-    //    printf("['10:00',  22,   -5],\r\n");
-//        printf("['10:30',  23,   -4],\r\n");
-//        printf("['11:00',  24,   0],\r\n");
-//        printf("['11:30',  25,   3],\r\n");
-//        printf("['12:00',  21,   5]\r\n");
-//        printf("]);\r\n");
-        for (char i=0; i<60; i++)
-        {
-          ltoa_format(buffer, hour, 1,0);
-          printf("['");
-          printf(buffer);
-          ltoa_format(buffer, i, 1,0);
-          printf(":");
-          printf(buffer);
-          printf("',");
-          ltoa_format(buffer, TempValues[i], 1,0);
-          printf(buffer);
-          if (i==59) printfln("]");
-          else printfln("],");
-        }
-        printfln("]);");
-        
-        printfln("var options = {");
-        printf("title: 'Temperaturverlauf',vAxis:{title: 'Temperatur [C]', maxValue:50, minValue:-20},backgroundColor: {strokeWidth:2, fill:'#CCCCFF'}");
-        printfln("};");
-        
-        printfln("var chart = new google.visualization.LineChart(document.getElementById('chart_div'));");
-        printfln("chart.draw(data, options);}");
-        
-        printfln("</script>");
-
-        // Gauge Chart  Begin      
-        
-//        printfln("<script type='text/javascript'>");
-//        printfln("google.load('visualization', '1', {packages:['gauge']});");
-//        printfln("google.setOnLoadCallback(drawChart);");
-//        printfln("function drawChart() {");
-//        printfln("var data = google.visualization.arrayToDataTable([");
-//        printfln("['Label', 'Value'],");
-//        printf("['Temp. 1',");
-//        ltoa_format(buffer, IntDegC, 1,0);
-//        printf(buffer);
-//        printfln("]");
-//        printfln("]);");
-//        printfln("var options = {");
-//        printf("width: 200, height: 200, redFrom: 40, redTo: 60, yellowFrom:10, yellowTo: 40, greenFrom: -20, greenTo: 10, min: -20, max: 60, minorTicks: 5");
-//        printfln("};");
-//        
-//        printfln("var chart = new google.visualization.Gauge(document.getElementById('chart_div2'));");
-//        printfln("chart.draw(data, options);}");
-//        
-//        printfln("</script>");
-        
-        // Gauge Chart End
-        
-        printfln("</head>");        
-        
-        printfln("<body bgcolor='#444444'>");
-        printfln("<br><hr />");
-        printfln("<h2><div align='left'><font color='#2076CD'> Webserver 1.0 </font color></div></h2>");
-        printfln("<hr /><br>");
-        printfln("<div align='left'><font face='Verdana' color='#FFFFFF'>");
-        printfln("<p><b>Aktueller Temperaturwert:");
-        ltoa_format(buffer, IntDegC, 1,0);
-        printf(buffer);
-        printfln(" C</b></p>");
-              
-        printfln("<p><b>Aktuelle Systemzeit:");
-        ltoa_format(buffer, hour, 1,0);
-        printf(buffer);
-        printf(":");
-        ltoa_format(buffer, minute, 1,0);
-        printf(buffer);
-        printf(":");
-        ltoa_format(buffer, second, 1,0);
-        printf(buffer);
-        printfln("</b></p>");
-        printfln("<br>");
-        printfln("<div align='left'><font face='Verdana' color='#FFFFFF'><b>LED schalten:</font></div>");
-        
-        printf("<br>");
-        // HTML-Table
-       // printf("<table border='1' width='500' cellpadding='5'>");
-       // printf("<tr bgColor='#222222'>");
-       // printf("<td bgcolor='#222222'><font face='Verdana' color='#CFCFCF' size='3'>LED Rot<br></font></td>");
-       // printf("<td align='center' bgcolor='#222222'><form method=get><input type=submit name=3 value='ein'></form></td>");
-       // printf("<td align='center' bgcolor='#222222'><form method=get><input type=submit name=3 value='aus'></form></td>");
-        
-        //if (P1OUT & 0x20) printf("<td align='center'><font color='red' size='5'>EIN");
-        //else printf("<td align='center'><font color='green' size='5'>AUS");
-
-        //printf("</tr>");
-        //printfln("</tr></tr></table><br>");
-        
-        printf("<form method=get><input type=submit name=3 value='EIN'></form>");
-        printf("<form method=get><input type=submit name=3 value='AUS'></form>");
-        if (P1OUT & 0x20) printf("LED Ausgang: EIN");
-        else printf("LED Ausgang: AUS");
-        
-        printfln("</b><br><br>");
-         
-        printfln("<div id='chart_div' style='width: 800px; height: 400px;'></div>");
-       // printfln("<br>");
-       // printfln("<div id='chart_div2'></div>");
-        
-        printfln("</body></html>");
-                    
+        case TX: // Request(s) received, answer one per pass
         FLAGS &= ~TX;
-        ME1 |= URXE0;                                       // Enable USART0 RXD
-       
+        Req = Request_Get();
+        if (Req == 0)
+          break;
+        Route_Dispatch(Routes, Req);
+        Request_Release();
+        FLAGS |= TX;                            // look for further requests
         break;
     }
   }
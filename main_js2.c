@@ -34,149 +34,30 @@
 // Use: http://192.168.0.102:2101/login.htm
 
 #include <msp430x14x.h>
+#include "uart_tx.h"
+#include "http.h"
+#include "request.h"
+#include "route.h"
+#include "pages.h"
 
 //#include "webside.h"
 
 // Define flags used by the interrupt routines
 #define TX BIT0
+#define SAMPLE BIT1                          // a minute is over
 
 // Flag register
 volatile unsigned char FLAGS = 0;
 
-char buffer[4];
-char IntDegC;
-char TempValues[60];
-char index;
-char hour=10;
-char minute=0;
-char second=0;
-char month=2;
-char day=1;
-int year=2013;
-
-/**
-* Sends a single byte out through UART
-**/
-void sendByte(unsigned char byte )
-  {
-  while (!(IFG1 & UTXIFG0)); // USART0 TX buffer ready?
-  TXBUF0 = byte;             // TX -> RXed character
-  }
-
-void putc(unsigned b)
-  {
-  sendByte(b);
-  }
-
-void printf(char *s)
-  {
-  char c;
-  
-  // Loops through each character in string 's'
-  while (c = *s++) {
-  sendByte(c);
-  }
-  }
-
-int ltoa_format (char *erg, long zahl, unsigned int vk, unsigned int nk)
-{ // Out-String, input long, pre-decimal digits, decimal digits, sign '+' or ' ' 
-  char vorz = '0'; 
-  long temp;
-   int  i;
-   i = vk + nk + 1;                   	// string length 
-   erg[i--] = 0;                      	// string end
-   if ( zahl == 0 )						// special case input = 0  
-   {
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) >= vk) ) // vk contain sign
-	   	{
-	      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed
-	      else erg[i--] = '0'; // detach digit, value = 0
-	  	}
-      if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-     } 
-   else 
-   {
-      if ( zahl < 0 )
-      {
-      vorz  = '-';                     // sign = '-'
-      zahl *=  -1;                     // calculate further with positive value
-      }
-      while( i >= 0 && 
-	       ( zahl > 0 || i+2*( nk != 0 ) > vk) ) // vk contain sign  
-      {
-      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed  
-      else 
-      {
-      temp     =  zahl / 10;           	// integer division  
-      erg[i--] = (zahl - temp*10) + 48; // detach digit, assign ASCII-value
-      zahl     =  temp;                	// for next pass reduce digit
-      }
-   	  }
-   if ( i >= 0 ) erg[i--] = vorz;      	// write sign
-   }
-   while( i >= 0 ) erg[i--] = ' ';     	// fill begin with spaces
-   return  vk + nk + 1;                	// return string length
-}
-
-// samples and returns AD-converter value of channel 10
-// (MSP430's internal temperature reference diode)
-// NOTE: to get a more exact value, 8-times oversampling is used
-
-char GetTempVal(void)
-{
-  unsigned long ReturnValue;
-
-  ADC12CTL0 = ADC12ON | SHT0_15 | MSH | REFON;   // ADC on, int. ref. on (1,5 V),
-                                                 // multiple sample & conversion
-  ADC12CTL1 = ADC12SSEL_2 | ADC12DIV_7 | CSTARTADD_0 | CONSEQ_1 | SHP;   // MCLK / 8 = 1 MHz
-
-  ADC12MCTL0 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL1 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL2 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL3 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL4 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL5 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL6 = SREF_1 | INCH_10;                 // int. ref., channel 10
-  ADC12MCTL7 = EOS | SREF_1 | INCH_10;           // int. ref., channel 10, last seg.
-  
-  ADC12CTL0 |= ENC;                              // enable conversion
-  ADC12CTL0 |= ADC12SC;                          // sample & convert
-  
-  while (ADC12CTL0 & ADC12SC);                   // wait until conversion is complete
-  
-  ADC12CTL0 &= ~ENC;                             // disable conversion
-
-  ReturnValue = ADC12MEM0;                       // sum up values...
-  ReturnValue += ADC12MEM1;
-  ReturnValue += ADC12MEM2;
-  ReturnValue += ADC12MEM3;
-  ReturnValue += ADC12MEM4;
-  ReturnValue += ADC12MEM5;
-  ReturnValue += ADC12MEM6;
-  ReturnValue += ADC12MEM7;
-
-  ReturnValue >>= 3;                             // ... and divide by 8
-  
-  ReturnValue = (ReturnValue - 2692) * 423;
-  ReturnValue = ReturnValue / 4096;
-
-  return ReturnValue;
-}
-
-
+Request *Req;
 
 #pragma vector=USART0RX_VECTOR
 __interrupt void usart0_rx (void)
 {
-  char r = RXBUF0;
- // P1OUT ^= 0x20;
-  
-  if (r == 'G')
+  if (Request_Byte(RXBUF0))                   // request complete?
   {
     FLAGS |= TX; // Set flag to transmit data
     _BIC_SR_IRQ(LPM3_bits);                   // Clear LPM3 bits from 0(SR)
-    _BIC_SR(GIE);
   }
 }
 
@@ -192,19 +73,39 @@ __interrupt void watchdog_timer(void)
   {
     second = 0;
     minute++;
-    IntDegC = GetTempVal();
-    TempValues[index++] = IntDegC;
+    FLAGS |= SAMPLE;                           // sampled in the main loop, Adc_Sample()
+    _BIC_SR_IRQ(LPM3_bits);                    // sleeps and Page_Status() uses it too
   }
   if (minute == 60)
   {
     minute = 0;
     hour++;
-    index = 0;
   }
-  if (hour==24) hour = 0;
+  if (hour==24)
+  {
+    hour = 0;
+    Csv_Forward(&Today, 24 * 60);            // next day
+  }
     
 }
 
+#define ROUTE_HASH_ROOT   ROUTE_H(ROUTE_SEED, '/')
+#define ROUTE_HASH_STATUS ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_HASH_ROOT, \
+                            's'), 't'), 'a'), 't'), 'u'), 's')
+#define ROUTE_HASH_DATA   ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_HASH_ROOT, \
+                            'd'), 'a'), 't'), 'a'), '.'), 'c'), 's'), 'v')
+
+ROUTE_CHECK(Route_Check_Data,   ROUTE_HASH_DATA,   1);
+ROUTE_CHECK(Route_Check_Status, ROUTE_HASH_STATUS, 2);
+ROUTE_CHECK(Route_Check_Root,   ROUTE_HASH_ROOT,   3);
+
+const Route Routes[ROUTE_SLOTS] = {
+  { 0,                 0 },
+  { ROUTE_HASH_DATA,   Page_Data },         // /data.csv
+  { ROUTE_HASH_STATUS, Page_Status },       // /status
+  { ROUTE_HASH_ROOT,   Page_Main }          // /
+};
+
 
 void main(void)
 {
@@ -241,130 +142,24 @@ void main(void)
   
   while(1)
   {
+    if (FLAGS & SAMPLE)
+    {
+      FLAGS &= ~SAMPLE;
+      Sample();
+    }
     switch(FLAGS)
     {
         case 0: // No flags set
         _BIS_SR(LPM3_bits + GIE); // Enter LPM3
         break;
         case TX: // Values need to be transmitted
-        //printf (WebSide);
-        //ADC12CTL0 |= ADC12SC;                   // Sampling and conversion start
-        //while (ADC12CTL0 & ADC12BUSY);          // ADC10BUSY?
-        //temp = ADC12MEM0; 
-       // IntDegC = (temp - 2692) * 423;
-       // IntDegC = IntDegC / 4096;
-                 
-        printf("HTTP/1.1 200 OK\r\n");
-        printf("Connection: Close\r\n");
-        printf("Content-Type: text/html; charset=windows-1250\r\n");
-       
-        printf("\r\n\r\n");
-        printf("<html><head>");
-        printf("<title>MSP430 - Webserver</title>");
-      
-        // Annotated Timeline Chart
-        printf("<script type='text/javascript' src='https://www.google.com/jsapi'></script>\r\n");
-        printf("<script type='text/javascript'>\r\n");
-        printf("google.load('visualization', '1', {packages:['annotatedtimeline']});\r\n");
-        printf("google.setOnLoadCallback(drawChart);\r\n");
-        printf("function drawChart() {\r\n");
-        printf("var data = new google.visualization.DataTable();\r\n");
-        printf("data.addColumn('datetime', 'Date');\r\n");
-        printf("data.addColumn('number', 'Temperatur 1');\r\n");
-        printf("data.addRows([\r\n");
-         
-        for (char i=0; i<60; i++)
-        {
-          ltoa_format(buffer, year, 3,0);
-          printf("[new Date(");
-          printf(buffer);
-          printf(",");
-          
-          ltoa_format(buffer, month, 1,0);
-          printf(buffer);
-          printf(",");
-         
-          ltoa_format(buffer, day, 1,0);
-          printf(buffer);
-          printf(",");
-          
-          ltoa_format(buffer, hour, 1,0);
-          printf(buffer);
-          printf(",");
-          
-          if (i<10) ltoa_format(buffer, i, 0,0);
-          else ltoa_format(buffer, i, 1,0);
-          printf(buffer);
-          printf("),");
-              
-          if (TempValues[i]==0) printf("0");  
-          else
-          {
-            ltoa_format(buffer, TempValues[i], 1,0);
-            printf(buffer);
-          }
-          if (i==59) printf("]\r\n");
-          else printf("],\r\n");
-        }
-        printf("]);\r\n");
-        
-        printf("var chart = new google.visualization.AnnotatedTimeLine(document.getElementById('chart_div'));\r\n");
-        printf("chart.draw(data, {displayAnnotations: true, max:60, min:-20, allValuesSuffix:'C'});}\r\n");
-        
-        printf("</script>\r\n");
-
-        // Gauge Chart  Begin      
-        printf("<script type='text/javascript'>\r\n");
-        printf("google.load('visualization', '1', {packages:['gauge']});\r\n");
-        printf("google.setOnLoadCallback(drawChart);\r\n");
-        printf("function drawChart() {\r\n");
-        printf("var data = google.visualization.arrayToDataTable([\r\n");
-        printf("['Label', 'Value'],\r\n");
-        printf("['Temp. 1',");
-        IntDegC =   GetTempVal();              // Get Temperature Value
-        ltoa_format(buffer, IntDegC, 1,0);
-        printf(buffer);
-        printf("]\r\n");
-        printf("]);\r\n");
-        printf("var options = {\r\n");
-        printf("width: 150, height: 150, redFrom: 40, redTo: 60, yellowFrom:10, yellowTo: 40, greenFrom: -20, greenTo: 10, min: -20, max: 60, minorTicks: 5");
-        printf("};\r\n");
-        
-        printf("var chart = new google.visualization.Gauge(document.getElementById('chart_div2'));\r\n");
-        printf("chart.draw(data, options);}\r\n");
-        
-        printf("</script>\r\n");
-        // Gauge Chart End
-        
-        printf("</head>\r\n");        
-        
-        printf("<body>\r\n");
-        printf("<p><b>Aktueller Temperaturwert:\r\n");
-        IntDegC =   GetTempVal();              // Get Temperature Value
-        ltoa_format(buffer, IntDegC, 1,0);
-        printf(buffer);
-        printf(" C</b></p>\r\n");
-                      
-        printf("<p><b>Aktuelle Systemzeit:\r\n");
-        ltoa_format(buffer, hour, 1,0);
-        printf(buffer);
-        printf(":");
-        ltoa_format(buffer, minute, 1,0);
-        printf(buffer);
-        printf(":");
-        ltoa_format(buffer, second, 1,0);
-        printf(buffer);
-        printf("</b></p>\r\n");
-        printf("<br>\r\n");
-        
-        printf("<div id='chart_div' style='width: 800px; height: 400px;'></div>\r\n");
-        printf("<br>\r\n");
-        printf("<div id='chart_div2'></div>\r\n");
-        printf("<br>\r\n");
-        
-        printf("</body></html>\r\n");
-                    
         FLAGS &= ~TX;
+        Req = Request_Get();
+        if (Req == 0)                           // one response per request
+          break;
+        Route_Dispatch(Routes, Req);
+        Request_Release();
+        FLAGS |= TX;                            // look for further requests
         //P2DIR ^= 0x04;
         break;
     }
@@ -36,6 +36,7 @@
 // Use: http://192.168.0.102:2101/login.htm
 
 #include <msp430x14x.h>
+#include "request.h"
 
 //#include "webside.h"
 
@@ -164,14 +165,10 @@ int GetTempVal(void)
 #pragma vector=USART0RX_VECTOR
 __interrupt void usart0_rx (void)
 {
-  char r = RXBUF0;
-  P1OUT ^= 0x20;
-  
-  if (r == 'G')
+  if (Request_Byte(RXBUF0))                   // request complete?
   {
     FLAGS |= TX; // Set flag to transmit data
     _BIC_SR_IRQ(LPM3_bits);                   // Clear LPM3 bits from 0(SR)
-    _BIC_SR(GIE);
   }
 }
 
@@ -215,6 +212,9 @@ void main(void)
         _BIS_SR(LPM3_bits + GIE); // Enter LPM3
         break;
         case TX: // Values need to be transmitted
+        FLAGS &= ~TX;
+        if (Request_Get() == 0)                 // one response per request
+          break;
         //printf (WebSide);
         //ADC12CTL0 |= ADC12SC;                   // Sampling and conversion start
         //while (ADC12CTL0 & ADC12BUSY);          // ADC10BUSY?
@@ -260,7 +260,8 @@ void main(void)
         
         printf("</body></html>\r\n");
                     
-        FLAGS &= ~TX;
+        Request_Release();
+        FLAGS |= TX;                            // look for further requests
         P2DIR ^= 0x04;
         break;
     }
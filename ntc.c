@@ -0,0 +1,63 @@
+//******************************************************************************
+//  ntc.c - Conversion of the external NTC (P6.0) reading into temperature
+//
+//  Temperature_Lookup[] holds the 10 bit ADC value of the NTC voltage divider
+//  for every full degree from TEMP_MIN_TEMP to TEMP_MAX_TEMP, falling with
+//  rising temperature. The table is searched binary (7 steps instead of up to
+//  120 compares) and the result is interpolated linearly between the two
+//  neighbouring entries. The 12 bit conversion result gives 4 times the table
+//  resolution, so 0.1 C steps are meaningful over the whole range.
+//
+//  Behaviour change: the old lookup returned the first full degree whose
+//  table entry was below the 10 bit value, i.e. it rounded up. Readings are
+//  now 0.6 C lower on average and up to 1.7 C where the table is flat
+//  (test/ntc_test.c), so the NTC curve steps down once at the update.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "ntc.h"
+
+static const unsigned int Temperature_Lookup[] = {
+  0x3E9, 0x3E7, 0x3E5, 0x3E4, 0x3E2, 0x3DF, 0x3DD, 0x3DB, 0x3D8, 0x3D6, 0x3D3,
+  0x3D0, 0x3CD, 0x3C9, 0x3C6, 0x3C2, 0x3BE, 0x3BA, 0x3B6, 0x3B2, 0x3AD, 0x3A8,
+  0x3A3, 0x39D, 0x398, 0x392, 0x38C, 0x385, 0x37F, 0x378, 0x371, 0x36A, 0x362,
+  0x35A, 0x352, 0x34A, 0x341, 0x338, 0x32F, 0x326, 0x31C, 0x312, 0x308, 0x2FE,
+  0x2F4, 0x2E9, 0x2DE, 0x2D3, 0x2C8, 0x2BD, 0x2B1, 0x2A6, 0x29A, 0x28F, 0x283,
+  0x277, 0x26B, 0x25F, 0x253, 0x247, 0x23B, 0x22F, 0x223, 0x217, 0x20B, 0x1FF,
+  0x1F3, 0x1E8, 0x1DC, 0x1D1, 0x1C5, 0x1BA, 0x1AF, 0x1A4, 0x199, 0x18F, 0x184,
+  0x17A, 0x170, 0x166, 0x15C, 0x153, 0x14A, 0x140, 0x137, 0x12F, 0x126, 0x11E,
+  0x116, 0x10E, 0x106, 0x0FE, 0x0F7, 0x0F0, 0x0E9, 0x0E2, 0x0DB, 0x0D5, 0x0CF,
+  0x0C9, 0x0C3, 0x0BD, 0x0B7, 0x0B2, 0x0AD, 0x0A8, 0x0A3, 0x09E, 0x099, 0x095,
+  0x090, 0x08C, 0x088, 0x084, 0x080, 0x07C, 0x079, 0x075, 0x072, 0x06E, 0x06B
+   };
+
+int Temperature_GetDeciDegrees(unsigned int Temp_ADC)
+{
+  unsigned char lo = 0;
+  unsigned char hi = TEMP_TABLE_SIZE - 1;
+  unsigned char mid;
+  unsigned int upper, span;
+
+  if (Temp_ADC >= (Temperature_Lookup[0] << 2))
+    return TEMP_MIN_TEMP * 10;
+  if (Temp_ADC <= (Temperature_Lookup[TEMP_TABLE_SIZE - 1] << 2))
+    return TEMP_MAX_TEMP * 10;
+
+  // Temperature_Lookup[lo] > Temp_ADC >= Temperature_Lookup[hi]
+  while (hi - lo > 1)
+  {
+    mid = (lo + hi) >> 1;
+    if (Temp_ADC < (Temperature_Lookup[mid] << 2))
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  upper = Temperature_Lookup[lo] << 2;
+  span = upper - (Temperature_Lookup[hi] << 2);
+
+  // whole degrees of 'lo' plus tenths of the way down to 'hi', rounded
+  return (lo + TEMP_MIN_TEMP) * 10 + ((upper - Temp_ADC) * 10 + (span >> 1)) / span;
+}
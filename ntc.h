@@ -0,0 +1,17 @@
+/*
+ntc.h - Conversion of the external NTC (P6.0) reading into temperature
+
+*/
+
+#ifndef _ntc_h
+#define _ntc_h
+
+#define TEMP_MIN_TEMP -40
+#define TEMP_MAX_TEMP 79
+#define TEMP_TABLE_SIZE 120
+
+// Temp_ADC is the averaged 12 bit conversion result (0..4095), the
+// result is the temperature in 0.1 deg C, e.g. 235 = 23.5 deg C
+int Temperature_GetDeciDegrees(unsigned int Temp_ADC);
+
+#endif /* _ntc_h */
@@ -0,0 +1,157 @@
+//******************************************************************************
+//  pages.c - Sensor sampling and the pages of the chart webserver
+//
+//  Shared by main_js1.c and main_js2.c, which keep the clock in their WDT
+//  ISR and add their own routes (main_js1.c: /led and the flash log).
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include "uart_tx.h"
+#include "adc.h"
+#include "ntc.h"
+#include "format.h"
+#include "http.h"
+#include "history.h"
+#include "csv.h"
+#include "chart.h"
+#include "pages.h"
+
+#define CHART_MINUTES 60                     // rows of /data.csv?r=h
+
+int IntDegC;                                 // deg C, signed
+char hour=10;
+char minute=0;
+char second=0;
+Csv_Stamp Today = { 2013, 2, 1, 0 };       // date, Minute unused
+int Values[HISTORY_SENSORS];                 // last minute sample, 0.1 deg C
+
+// returns temperature of channel 10 from the last Adc_Sample() sequence
+// (MSP430's internal temperature reference diode)
+// in deg C, signed: plain char is unsigned in this project (CCCharIs=1)
+// NOTE: to get a more exact value, 8-times oversampling is used
+
+int GetTempVal(void)
+{
+  long ReturnValue;
+
+  ReturnValue = Adc_GetAverage(ADC_CH_INTERNAL);
+  
+  ReturnValue = (ReturnValue - 2692) * 423;
+  ReturnValue = ReturnValue / 4096;
+
+  return ReturnValue;
+}
+
+// returns temperature of the external NTC (A0) in 0.1 deg C
+int GetTempVal2(void)
+{
+  return Temperature_GetDeciDegrees(Adc_GetAverage(ADC_CH_NTC));
+}
+
+// the minute sample: ADC sequence and history
+void Sample(void)
+{
+  Adc_Sample();
+  IntDegC = GetTempVal();
+  Values[0] = IntDegC * 10;
+  Values[1] = GetTempVal2();
+  History_Add(Values);
+}
+
+// ?3=EIN / ?3=AUS from the form of the chart page switches the red LED
+void Led_Command(Request *r)
+{
+  const char *LedCommand = Request_GetParam(r, "3");
+
+  if (LedCommand && LedCommand[0] == 'E')
+    P1OUT |= 0x20;
+  if (LedCommand && LedCommand[0] == 'A')
+    P1OUT &= ~0x20;
+}
+
+// Main page, static, the chart loads /data.csv
+void Page_Main(Request *r)
+{
+  Led_Command(r);
+  Http_Static(r, "text/html", CHART_ETAG, Chart_Shell, Chart_Length);
+}
+
+// /status: temperature;time;LED
+void Page_Status(Request *r)
+{
+  Adc_Sample();
+  IntDegC = GetTempVal();
+  Http_BeginChunked("text/plain");
+  Format_Signed(IntDegC);
+  printf(";");
+  Format_Unsigned(hour);
+  printf(":");
+  Format_Width(minute, 2, '0');
+  printf(":");
+  Format_Width(second, 2, '0');
+  printf(";");
+  if (P1OUT & 0x20) printfln("EIN");
+  else printfln("AUS");
+  Http_EndChunked();
+}
+
+// /data.csv?r=h|d|w: minutes of the last hour, quarter hours of the last
+// day or hours of the last week, aggregates as "min;avg;max"
+void Page_Data(Request *r)
+{
+  const char *range = Request_GetParam(r, "r");
+  unsigned char tier = HISTORY_MINUTE;
+  unsigned char step = 1;
+  unsigned char s;
+  unsigned int i, n, first = 0;
+  History_Point p;
+  Csv_Stamp t = Today;
+
+  if (range && range[0] == 'd')
+  {
+    tier = HISTORY_QUARTER;
+    step = 15;
+  }
+  else if (range && range[0] == 'w')
+  {
+    tier = HISTORY_HOUR;
+    step = 60;
+  }
+  n = History_Count(tier);
+  if (tier == HISTORY_MINUTE && n > CHART_MINUTES)
+    first = n - CHART_MINUTES;
+
+  Http_BeginChunked("text/csv");
+  printfln("Date,Temperatur 1,Temperatur 2");
+  if (n != 0)
+  {
+    t.Minute = hour * 60 + minute;             // time of the last sample
+    Csv_Back(&t, (n - first - 1) * step + step - 1 + (unsigned int)(History_Samples % step));
+  }
+  for (i = first; i < n; i++)
+  {
+    Csv_Date(&t);
+    for (s = 0; s < HISTORY_SENSORS; s++)
+    {
+      History_Get(tier, s, i, &p);
+      printf(",");
+      if (tier != HISTORY_MINUTE)
+      {
+        Format_Fixed(p.Min, 1);
+        printf(";");
+      }
+      Format_Fixed(p.Avg, 1);
+      if (tier != HISTORY_MINUTE)
+      {
+        printf(";");
+        Format_Fixed(p.Max, 1);
+      }
+    }
+    printfln("");
+    Csv_Forward(&t, step);
+  }
+  Http_EndChunked();
+}
@@ -0,0 +1,34 @@
+/*
+pages.h - Sensor sampling and the pages of the chart webserver
+
+Sample() takes the minute sample of both sensors into the history. The
+pages answer / (chart.h), /status and /data.csv?r=h|d|w from it. The
+clock hour:minute:second and the date Today are advanced by the WDT ISR
+of the main file.
+
+*/
+
+#ifndef _pages_h
+#define _pages_h
+
+#include "request.h"
+#include "history.h"
+#include "csv.h"
+
+extern int IntDegC;                          // deg C, signed
+extern char hour;
+extern char minute;
+extern char second;
+extern Csv_Stamp Today;                      // date, Minute unused
+extern int Values[HISTORY_SENSORS];          // last minute sample, 0.1 deg C
+
+int GetTempVal(void);                        // internal sensor, deg C
+int GetTempVal2(void);                       // NTC, 0.1 deg C
+void Sample(void);                           // ADC sequence and History_Add()
+
+void Led_Command(Request *r);                // ?3=EIN / ?3=AUS
+void Page_Main(Request *r);                  // /
+void Page_Status(Request *r);                // /status
+void Page_Data(Request *r);                  // /data.csv
+
+#endif /* _pages_h */
@@ -0,0 +1,362 @@
+//******************************************************************************
+//  request.c - Incremental HTTP request parser for the USART0 RX ISR
+//
+//  One state per syntactic element of the request. Fixed words (method,
+//  header names, Connection values) are compared while they come in: a bit
+//  mask keeps the candidates which still match, so there is no line buffer.
+//  An empty line ends the request and hands its slot over to main(), a
+//  body announced by Content-Length is skipped after it. If the queue is
+//  full, the request is skipped up to the end of its body.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "request.h"
+#include "route.h"
+
+// Parser states
+#define S_START        0                     // before method, skip empty lines
+#define S_METHOD       1
+#define S_PATH         2
+#define S_PARAM_NAME   3
+#define S_PARAM_VALUE  4
+#define S_PARAM_SKIP   13                    // no slot left for this parameter
+#define S_VERSION      5                     // "HTTP/1.x"
+#define S_LINE_START   6                     // start of a header line or empty line
+#define S_HEADER_NAME  7
+#define S_HEADER_SPACE 8                     // blanks after ':'
+#define S_HEADER_VALUE 9
+#define S_SKIP_LINE    10                    // ignore up to '\n'
+#define S_BODY         11                    // skip 'Body' bytes
+
+// Header we are interested in
+#define H_CONNECTION 0
+#define H_ETAG       1
+#define H_LENGTH     2
+#define H_NONE       0xFF
+
+static const char * const Request_Methods[] = { "GET", "HEAD", "POST" };
+static const char * const Request_Headers[] = { "connection", "if-none-match", "content-length" };
+static const char * const Request_Connection[] = { "close", "keep-alive" };
+
+static Request Request_Queue[REQUEST_QUEUE_SIZE];
+static unsigned char Request_In = 0;         // slot being parsed
+static unsigned char Request_Out = 0;        // oldest complete request
+static volatile unsigned char Request_Count = 0;
+volatile unsigned char Request_Dropped = 0;
+
+static Request *R;                           // == &Request_Queue[Request_In] while parsing
+static unsigned char State = S_START;
+static unsigned char Pos;                    // position in the current word
+static unsigned char Match;                  // bit mask of candidates still matching
+static unsigned char Header;                 // H_xxx of the current header line
+static unsigned char Dropping;               // queue full, the request has no slot
+static unsigned int Body;                    // Content-Length, bytes left in S_BODY
+
+static char Request_Lower(char c)
+{
+  if (c >= 'A' && c <= 'Z')
+    return c + ('a' - 'A');
+  return c;
+}
+
+// clears the bit of every candidate without 'c' at 'Pos'
+static void Request_Narrow(const char * const *list, unsigned char n, char c)
+{
+  unsigned char i;
+
+  for (i = 0; i < n; i++)
+    if ((Match & (1 << i)) && (list[i][Pos] == 0 || list[i][Pos] != c))
+      Match &= ~(1 << i);
+  Pos++;
+}
+
+// index of the candidate matching completely, or H_NONE
+static unsigned char Request_Matched(const char * const *list, unsigned char n)
+{
+  unsigned char i;
+
+  for (i = 0; i < n; i++)
+    if ((Match & (1 << i)) && list[i][Pos] == 0)
+      return i;
+  return H_NONE;
+}
+
+static void Request_Begin(void)
+{
+  Body = 0;
+  Dropping = Request_Count == REQUEST_QUEUE_SIZE;
+  if (Dropping)
+  {
+    Request_Dropped++;                       // only the headers for the body length
+    State = S_SKIP_LINE;
+    return;
+  }
+  R = &Request_Queue[Request_In];
+  R->Method = REQUEST_OTHER;
+  R->Flags = 0;
+  R->Path[0] = 0;
+  R->PathHash = ROUTE_SEED;
+  R->ParamCount = 0;
+  R->ETag[0] = 0;
+  Pos = 0;
+  Match = 0xFF;
+  State = S_METHOD;
+}
+
+static unsigned char Request_End(void)
+{
+  State = Body ? S_BODY : S_START;
+  if (Dropping)
+    return 0;
+  Request_In = (Request_In + 1) % REQUEST_QUEUE_SIZE;
+  Request_Count++;
+  return 1;
+}
+
+// one character of the Content-Length value
+static void Request_Length(char c)
+{
+  if (c == ' ' || c == '\t')
+    return;
+  if (c >= '0' && c <= '9' && Body < 6000)   // no 16 bit overflow
+    Body = Body * 10 + (c - '0');
+  else
+  {
+    Body = 0;
+    Header = H_NONE;
+    if (!Dropping)
+      R->Flags |= REQUEST_BAD | REQUEST_CLOSE; // can't find the end of the body
+  }
+}
+
+// appends 'c' to a fixed field of 'size' bytes
+static void Request_Store(char *field, unsigned char size, char c)
+{
+  if (Pos < size - 1)
+  {
+    field[Pos++] = c;
+    field[Pos] = 0;
+  }
+  else
+    R->Flags |= REQUEST_TRUNCATED;
+}
+
+static void Request_NextParam(void)
+{
+  Pos = 0;
+  if (R->ParamCount < REQUEST_PARAMS)
+  {
+    R->Params[R->ParamCount].Name[0] = 0;
+    R->Params[R->ParamCount].Value[0] = 0;
+    R->ParamCount++;
+    State = S_PARAM_NAME;
+  }
+  else
+  {
+    R->Flags |= REQUEST_TRUNCATED;
+    State = S_PARAM_SKIP;
+  }
+}
+
+unsigned char Request_Byte(unsigned char c)
+{
+  if (c == '\r' && State != S_BODY)          // CRLF and bare LF are both accepted
+    return 0;
+
+  switch (State)
+  {
+    case S_START:
+      if (c == '\n')
+        return 0;
+      Request_Begin();
+      if (State != S_METHOD)
+        return 0;
+      // fall through, first character of the method
+    case S_METHOD:
+      if (c == ' ')
+      {
+        unsigned char m = Request_Matched(Request_Methods, 3);
+        if (m != H_NONE)
+          R->Method = m + REQUEST_GET;
+        Pos = 0;
+        State = S_PATH;
+      }
+      else if (c == '\n' || Pos == 7)
+      {
+        R->Flags |= REQUEST_BAD;
+        State = c == '\n' ? S_LINE_START : S_SKIP_LINE;
+      }
+      else
+        Request_Narrow(Request_Methods, 3, c);
+      break;
+
+    case S_PATH:
+      if (c == ' ')
+      {
+        Pos = 0;
+        State = S_VERSION;
+      }
+      else if (c == '?')
+        Request_NextParam();
+      else if (c == '\n')
+      {
+        R->Flags |= REQUEST_BAD;             // HTTP/0.9 is not supported
+        State = S_LINE_START;
+      }
+      else
+      {
+        R->PathHash = ROUTE_H(R->PathHash, c);
+        Request_Store(R->Path, REQUEST_PATH_SIZE, c);
+      }
+      break;
+
+    case S_PARAM_NAME:
+    case S_PARAM_VALUE:
+    case S_PARAM_SKIP:
+      if (c == ' ')
+      {
+        Pos = 0;
+        State = S_VERSION;
+      }
+      else if (c == '&')
+        Request_NextParam();
+      else if (c == '=' && State == S_PARAM_NAME)
+      {
+        Pos = 0;
+        State = S_PARAM_VALUE;
+      }
+      else if (c == '\n')
+      {
+        R->Flags |= REQUEST_BAD;
+        State = S_LINE_START;
+      }
+      else if (State == S_PARAM_NAME)
+        Request_Store(R->Params[R->ParamCount - 1].Name, REQUEST_NAME_SIZE, c);
+      else if (State == S_PARAM_VALUE)
+        Request_Store(R->Params[R->ParamCount - 1].Value, REQUEST_VALUE_SIZE, c);
+      break;
+
+    case S_VERSION:                          // "HTTP/1.0" closes by default
+      if (c == '\n')
+      {
+        if (Pos != 8)
+          R->Flags |= REQUEST_BAD;
+        State = S_LINE_START;
+      }
+      else
+      {
+        if (Pos == 7 && c == '0')
+          R->Flags |= REQUEST_CLOSE | REQUEST_HTTP10;
+        if (Pos < 0xFF)
+          Pos++;
+      }
+      break;
+
+    case S_LINE_START:
+      if (c == '\n')
+        return Request_End();                // empty line, request complete
+      Pos = 0;
+      Match = 0xFF;
+      State = S_HEADER_NAME;
+      // fall through
+    case S_HEADER_NAME:
+      if (c == ':')
+      {
+        Header = Request_Matched(Request_Headers, 3);
+        if (Dropping && Header != H_LENGTH)
+          Header = H_NONE;
+        Pos = 0;
+        Match = 0xFF;
+        State = Header == H_NONE ? S_SKIP_LINE : S_HEADER_SPACE;
+      }
+      else if (c == '\n')
+        State = S_LINE_START;                // line without ':' is ignored
+      else if (Match)
+        Request_Narrow(Request_Headers, 3, Request_Lower(c));
+      break;
+
+    case S_HEADER_SPACE:
+      if (c == ' ' || c == '\t')
+        break;
+      State = S_HEADER_VALUE;
+      // fall through
+    case S_HEADER_VALUE:
+      if (c == '\n')
+      {
+        if (Header == H_CONNECTION)
+        {
+          unsigned char v = Request_Matched(Request_Connection, 2);
+          if (v == 0)
+            R->Flags |= REQUEST_CLOSE;
+          else if (v == 1)
+            R->Flags &= ~REQUEST_CLOSE;
+        }
+        State = S_LINE_START;
+      }
+      else if (Header == H_LENGTH)
+        Request_Length(c);
+      else if (Header == H_ETAG)
+      {
+        if (Pos < REQUEST_ETAG_SIZE - 1)
+        {
+          R->Flags |= REQUEST_ETAG;
+          Request_Store(R->ETag, REQUEST_ETAG_SIZE, c);
+        }
+        else
+        {
+          R->Flags &= ~REQUEST_ETAG;         // too long to be one of ours, no 304
+          Header = H_NONE;
+        }
+      }
+      else if (Match)
+        Request_Narrow(Request_Connection, 2, Request_Lower(c));
+      break;
+
+    case S_SKIP_LINE:
+      if (c == '\n')
+        State = S_LINE_START;
+      break;
+
+    case S_BODY:
+      if (--Body == 0)
+        State = S_START;
+      break;
+  }
+  return 0;
+}
+
+Request *Request_Get(void)
+{
+  if (Request_Count == 0)
+    return 0;
+  return &Request_Queue[Request_Out];
+}
+
+void Request_Release(void)
+{
+  Request_Out = (Request_Out + 1) % REQUEST_QUEUE_SIZE;
+  Request_Count--;                           // single instruction, safe against the ISR
+}
+
+const char *Request_GetParam(const Request *r, const char *name)
+{
+  unsigned char i;
+  const char *a;
+  const char *b;
+
+  for (i = 0; i < r->ParamCount; i++)
+  {
+    a = r->Params[i].Name;
+    b = name;
+    while (*a && *a == *b)
+    {
+      a++;
+      b++;
+    }
+    if (*a == 0 && *b == 0)
+      return r->Params[i].Value;
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+/*
+request.h - Incremental HTTP request parser for the USART0 RX ISR
+
+Request_Byte() is called with every received byte and does a constant
+amount of work per byte. Method, path, query parameters and the headers
+If-None-Match and Connection are parsed straight into fixed fields of
+a small queue of requests, other headers are skipped. A body (POST) is
+skipped by its Content-Length; a length that is not a number below 60000
+marks the request REQUEST_BAD | REQUEST_CLOSE. Requests may be split at
+any byte and may follow each other without pause (pipelining).
+
+*/
+
+#ifndef _request_h
+#define _request_h
+
+#define REQUEST_QUEUE_SIZE 2                 // complete requests waiting for main()
+#define REQUEST_PATH_SIZE  16                // incl. terminating 0
+#define REQUEST_PARAMS     2
+#define REQUEST_NAME_SIZE  4
+#define REQUEST_VALUE_SIZE 8
+#define REQUEST_ETAG_SIZE  12
+
+// Method
+#define REQUEST_OTHER 0
+#define REQUEST_GET   1
+#define REQUEST_HEAD  2
+#define REQUEST_POST  3
+
+// Flags
+#define REQUEST_BAD       0x01               // malformed request line, answer 400
+#define REQUEST_TRUNCATED 0x02               // path or parameters too long, answer 414
+#define REQUEST_CLOSE     0x04               // close connection after response
+#define REQUEST_ETAG      0x08               // If-None-Match present
+#define REQUEST_HTTP10    0x10               // HTTP/1.0 client, no chunked body
+
+typedef struct
+{
+  char Name[REQUEST_NAME_SIZE];
+  char Value[REQUEST_VALUE_SIZE];
+} Request_Param;
+
+typedef struct
+{
+  unsigned char Method;
+  unsigned char Flags;
+  char Path[REQUEST_PATH_SIZE];
+  unsigned short PathHash;                   // of the whole path, see route.h
+  unsigned char ParamCount;
+  Request_Param Params[REQUEST_PARAMS];
+  char ETag[REQUEST_ETAG_SIZE];
+} Request;
+
+unsigned char Request_Byte(unsigned char c); // 1 if a request is complete
+Request *Request_Get(void);                  // oldest complete request or 0
+void Request_Release(void);                  // done with Request_Get()
+const char *Request_GetParam(const Request *r, const char *name);  // value or 0
+
+extern volatile unsigned char Request_Dropped; // requests lost, queue was full
+
+#endif /* _request_h */
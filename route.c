@@ -0,0 +1,25 @@
+//******************************************************************************
+//  route.c - Path dispatch with a perfect hash
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "route.h"
+#include "http.h"
+
+void Route_Dispatch(const Route *table, Request *r)
+{
+  const Route *route = &table[ROUTE_SLOT(r->PathHash)];
+
+  Http_Begin(r);
+  if (r->Flags & REQUEST_BAD)
+    Http_Error("400 Bad Request");
+  else if (r->Flags & REQUEST_TRUNCATED)     // handler would see a cut parameter
+    Http_Error("414 Request-URI Too Long");
+  else if (route->Handler && route->Hash == r->PathHash)
+    route->Handler(r);
+  else
+    Http_Error("404 Not Found");
+  Http_End();
+}
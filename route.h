@@ -0,0 +1,40 @@
+/*
+route.h - Path dispatch with a perfect hash
+
+The parser hashes the path while it comes in (ROUTE_H() per byte, no
+string compare later). A route table has ROUTE_SLOTS entries, the route
+with path hash h sits at ROUTE_SLOT(h). The hashes of the route strings
+are constant expressions of ROUTE_H(), ROUTE_CHECK() makes the compiler
+reject a table where two routes would share a slot. With a new route,
+ROUTE_SEED/ROUTE_SHIFT may have to change until all slots are distinct.
+
+*/
+
+#ifndef _route_h
+#define _route_h
+
+#include "request.h"
+
+#define ROUTE_SEED  0
+#define ROUTE_SHIFT 2
+#define ROUTE_SLOTS 4                        // power of 2
+
+// one step of the path hash: h * 33 ^ c, 16 bit
+#define ROUTE_H(h, c) ((unsigned short)((((h) << 5) + (h)) ^ (c)))
+#define ROUTE_SLOT(h) (((h) >> ROUTE_SHIFT) & (ROUTE_SLOTS - 1))
+
+// compile time check, 'hash' must belong to table entry 'slot'
+#define ROUTE_CHECK(name, hash, slot) typedef char name[ROUTE_SLOT(hash) == (slot) ? 1 : -1]
+
+typedef void (*Route_Handler)(Request *r);
+
+typedef struct
+{
+  unsigned short Hash;                       // path hash, see ROUTE_H()
+  Route_Handler Handler;                     // 0 = free slot
+} Route;
+
+// calls the handler of the request path or answers 400, 414 or 404
+void Route_Dispatch(const Route *table, Request *r);
+
+#endif /* _route_h */
@@ -0,0 +1,81 @@
+//******************************************************************************
+//  template.c - HTTP responses from fixed flash text and fixed width slots
+//
+//  The value of a slot is clamped to what fits into its width, so the body
+//  is always exactly 'Length' bytes and the browser can rely on the
+//  Content-Length instead of waiting for the connection to close.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "uart_tx.h"
+#include "format.h"
+#include "template.h"
+#include "http.h"
+
+// largest magnitude for 0..5 digits
+static const int Template_Max[] = { 0, 9, 99, 999, 9999, 32767 };
+
+static void Template_Pad(unsigned char n, unsigned char width)
+{
+  for (; n < width; n++)
+    sendByte(' ');
+}
+
+static void Template_Slot(unsigned char type, unsigned char width, int value)
+{
+  unsigned char digits = width;
+  unsigned int magnitude;
+
+  if (type == SLOT_FIXED1)
+    digits--;                                // decimal point
+  if (value < 0)
+  {
+    if (type == SLOT_UNSIGNED || (type == SLOT_FIXED1 && digits < 3))
+      value = 0;                             // no room for the sign
+    else if (value < -Template_Max[digits - 1])
+      value = -Template_Max[digits - 1];     // sign takes one digit
+  }
+  if (value > Template_Max[digits])
+    value = Template_Max[digits];
+
+  switch (type)
+  {
+    case SLOT_UNSIGNED:
+      Format_Width(value, width, '0');
+      break;
+    case SLOT_SIGNED:
+      magnitude = value < 0 ? -(unsigned int)value : value;
+      Template_Pad((value < 0) + Format_Length(magnitude), width);
+      Format_Signed(value);
+      break;
+    case SLOT_FIXED1:
+      magnitude = value < 0 ? -(unsigned int)value : value;
+      digits = Format_Length(magnitude);
+      if (digits < 2)
+        digits = 2;                          // "0.5"
+      Template_Pad((value < 0) + digits + 1, width);
+      Format_Fixed(value, 1);
+      break;
+  }
+}
+
+void Template_Send(const Template *page, const int *values)
+{
+  const Template_Part *part = page->Parts;
+  unsigned char i;
+
+  Http_Header(page->ContentType);
+  printf("Content-Length: ");
+  Format_Unsigned(page->Length);
+  printfln("");
+  Http_Body();
+
+  for (i = 0; i < page->Count; i++, part++)
+  {
+    printf(part->Text);
+    if (part->Type != SLOT_NONE)
+      Template_Slot(part->Type, part->Width, *values++);
+  }
+}
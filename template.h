@@ -0,0 +1,45 @@
+/*
+template.h - HTTP responses from fixed flash text and fixed width slots
+
+A page is a list of parts, each one a constant text followed by an
+optional slot for a value. Every slot has a fixed width, so the
+Content-Length is a constant expression: TEMPLATE_TEXT() of all texts
+plus the slot widths. Template_Send() needs no sizing pass and no buffer.
+
+A page lists its parts once in a macro taking PART(text, type, width)
+and expands it with TEMPLATE_PART for the table and with TEMPLATE_LENGTH
+(after a 0) for the Content-Length, see webside.c.
+
+*/
+
+#ifndef _template_h
+#define _template_h
+
+#define SLOT_NONE     0                      // text only
+#define SLOT_UNSIGNED 1                      // zero padded, e.g. "007"
+#define SLOT_SIGNED   2                      // right aligned, e.g. " -5"
+#define SLOT_FIXED1   3                      // 0.1 units, right aligned, e.g. " 23.5"
+
+#define TEMPLATE_TEXT(s) (sizeof (s) - 1)    // length of a text array
+#define TEMPLATE_PART(text, type, width) { text, type, width },
+#define TEMPLATE_LENGTH(text, type, width) + TEMPLATE_TEXT(text) + (width)
+
+typedef struct
+{
+  const char *Text;                          // sent as it is
+  unsigned char Type;                        // slot after the text, SLOT_xxx
+  unsigned char Width;                       // characters of the slot, max. 5
+} Template_Part;
+
+typedef struct
+{
+  const char *ContentType;
+  unsigned int Length;                       // Content-Length, see TEMPLATE_TEXT()
+  const Template_Part *Parts;
+  unsigned char Count;                       // number of parts
+} Template;
+
+// sends status line, headers and body, values[] holds one int per slot
+void Template_Send(const Template *page, const int *values);
+
+#endif /* _template_h */
@@ -0,0 +1,211 @@
+//******************************************************************************
+//  alarm_test.c - Tickless Timer_A alarms and clock
+//
+//  Timer_A is played from interrupt to interrupt: TAR jumps to the next
+//  overflow or CCR1 match, sets the flag and the ISR of alarm.c runs. The
+//  tasks of main.c (5 minute sample, LED flash every 60 s) run whenever an
+//  event was posted. 13 days cover the wrap of the 32 bit tick count.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include "alarm.h"
+#include "check.h"
+
+#define EVENT_SAMPLE 0
+#define EVENT_LED    1
+#define EVENT_OTHER  2
+
+void Alarm_Isr(void);
+
+static unsigned char Posted[8];
+static unsigned long Ticks;                  // since Alarm_Init()
+
+void Event_Post(unsigned char event)
+{
+  Posted[event]++;
+}
+
+static unsigned char Pending(void)
+{
+  return (TACTL & (TAIE | TAIFG)) == (TAIE | TAIFG)
+         || (TACCTL1 & (CCIE | CCIFG)) == (CCIE | CCIFG);
+}
+
+static void Start(void)
+{
+  unsigned char i;
+
+  for (i = 0; i < sizeof Posted; i++)
+    Posted[i] = 0;
+  TAR = 0;
+  Ticks = 0;
+  Alarm_Wakeups = 0;
+  Alarm_Init();
+  TACTL &= ~TACLR;                           // done by the timer
+}
+
+// runs the timer for up to 'ticks', returns early when an event is posted
+static void Run(unsigned long ticks)
+{
+  unsigned long step, match;
+  unsigned char posted = 0, i;
+
+  while (ticks && !posted)
+  {
+    step = 0x10000UL - TAR;                  // to the overflow
+    if (TACCTL1 & CCIE)
+    {
+      match = (unsigned short)(TACCR1 - TAR);
+      if (match != 0 && match < step)
+        step = match;
+    }
+    if (step > ticks)
+      step = ticks;
+    TAR = (unsigned short)(TAR + step);
+    Ticks += step;
+    ticks -= step;
+    if (TAR == 0)
+      TACTL |= TAIFG;
+    if (TAR == TACCR1)
+      TACCTL1 |= CCIFG;
+    while (Pending())
+      Alarm_Isr();
+    for (i = 0; i < sizeof Posted; i++)
+      posted |= Posted[i];
+  }
+}
+
+// main.c's schedule, every event checked against the tick it was due
+static void Test_Schedule(void)
+{
+  unsigned long end = ALARM_TICKS(13 * 86400UL), sampleAt, ledAt, late = 0, wrong = 0;
+  unsigned long samples = 0, flashes = 0, wakeups;
+  unsigned char on = 0;
+
+  Start();
+  sampleAt = ALARM_TICKS(300);
+  Alarm_Set(0, sampleAt, EVENT_SAMPLE);
+  ledAt = ALARM_TICKS(60);
+  Alarm_Set(1, ledAt, EVENT_LED);
+  while (Ticks < end)
+  {
+    Run(end - Ticks);
+    if (Posted[EVENT_SAMPLE])
+    {
+      Posted[EVENT_SAMPLE] = 0;
+      samples++;
+      if (Ticks != sampleAt)
+        late++;
+      if (Alarm_Now() != (unsigned long)Ticks || Alarm_Seconds() != Ticks / ALARM_HZ)
+        wrong++;
+      sampleAt += ALARM_TICKS(300);
+      Alarm_Set(0, sampleAt, EVENT_SAMPLE);
+    }
+    if (Posted[EVENT_LED])
+    {
+      Posted[EVENT_LED] = 0;
+      flashes++;
+      on = !on;
+      if (on)                                // the flash, due at 'ledAt'
+      {
+        if (Ticks != ledAt)
+          late++;
+        Alarm_Set(1, Alarm_Now() + ALARM_HZ / 32, EVENT_LED);
+      }
+      else
+      {
+        ledAt += ALARM_TICKS(60);
+        Alarm_Set(1, ledAt, EVENT_LED);
+      }
+    }
+  }
+  CHECK(samples == 13 * 288);
+  CHECK(flashes == 13 * 1440 * 2 - 1);      // the last one is still on
+  CHECK(late == 0);
+  CHECK(wrong == 0);
+  CHECK(Alarm_Seconds() == 13 * 86400UL);
+  CHECK(Alarm_Now() == (unsigned long)end);  // wrapped once
+  wakeups = Alarm_Wakeups;
+  CHECK(wakeups <= samples + flashes + end / 0x10000);
+  Check_Note("alarm: %lu wake-ups per day (%lu overflows, %lu samples, %lu LED edges), "
+             "1 Hz WDT: 86400\n", wakeups / 13, end / 0x10000 / 13, samples / 13, flashes / 13);
+}
+
+static void Test_Set(void)
+{
+  unsigned long now;
+
+  Start();
+  Run(1000);
+  now = Alarm_Now();
+  Alarm_Set(2, now + 2, EVENT_OTHER);        // closer than ALARM_MIN: at once
+  CHECK(Posted[EVENT_OTHER] == 1);
+  Alarm_Set(2, now - 500, EVENT_OTHER);      // in the past: at once
+  CHECK(Posted[EVENT_OTHER] == 2);
+  Posted[EVENT_OTHER] = 0;
+
+  Alarm_Set(2, now + 100, EVENT_OTHER);      // replaced before it is due
+  Alarm_Set(2, now + 200000, EVENT_OTHER);   // beyond one counter period
+  Run(100000);
+  CHECK(Posted[EVENT_OTHER] == 0);
+  Run(200000);
+  CHECK(Posted[EVENT_OTHER] == 1 && Ticks == 1000 + 200000);
+  Posted[EVENT_OTHER] = 0;
+
+  Alarm_Set(2, Alarm_Now() + 50, EVENT_OTHER);
+  Alarm_Cancel(2);
+  Run(100000);
+  CHECK(Posted[EVENT_OTHER] == 0);
+}
+
+// TAR passes CCR1 before it is written: the alarm fires at once, not a
+// counter period (16 s) late
+static void Test_Late(void)
+{
+  unsigned long now;
+
+  Start();
+  Run(1000);
+  now = Alarm_Now();
+  Sim_TarAfter = 3;                          // 10 ticks between Alarm_Now() and CCR1
+  Sim_TarJump = 10;
+  Alarm_Set(2, now + 6, EVENT_OTHER);
+  CHECK(Posted[EVENT_OTHER] == 0 && Sim_TarAfter == 0);
+  CHECK(Pending());
+  while (Pending())
+    Alarm_Isr();
+  CHECK(Posted[EVENT_OTHER] == 1);
+
+  Posted[EVENT_OTHER] = 0;                   // ahead of TAR: left to CCR1
+  now = Alarm_Now();
+  Alarm_Set(2, now + 0xFFFF, EVENT_OTHER);
+  CHECK(!Pending());
+}
+
+// an overflow the ISR has not seen yet is counted by Alarm_Now()
+static void Test_Overflow(void)
+{
+  unsigned long before;
+
+  Start();
+  Run(0x10000UL - 5);
+  before = Alarm_Now();
+  TAR = 3;                                   // 8 ticks later, interrupts held
+  TACTL |= TAIFG;
+  CHECK(Alarm_Now() == before + 8);
+  CHECK(Alarm_Seconds() == (before + 8) / ALARM_HZ);
+  while (Pending())
+    Alarm_Isr();
+  CHECK(Alarm_Now() == before + 8);
+}
+
+int main(void)
+{
+  Test_Schedule();
+  Test_Set();
+  Test_Late();
+  Test_Overflow();
+  return Check_Done("alarm_test");
+}
@@ -0,0 +1,40 @@
+/*
+Arduino.h - Host stand-in for the Arduino core, as far as Nimbits.cpp and
+the tests use it. millis() is the clock of w5100.cpp, delay() advances it.
+
+*/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+unsigned long millis(void);
+void delay(unsigned long ms);
+
+// fixed size, long enough for every String the library builds
+class String {
+  public:
+    String() { s[0] = 0; }
+    String(const char *c) { s[0] = 0; *this += c; }
+    const char *c_str() const { return s; }
+    unsigned int length() const { return strlen(s); }
+    String &operator+=(const char *c) { strncat(s, c, sizeof s - strlen(s) - 1); return *this; }
+    String &operator+=(char c) { char b[2] = { c, 0 }; return *this += b; }
+  private:
+    char s[256];
+};
+
+#include "Print.h"
+
+#endif
@@ -0,0 +1,17 @@
+/*
+Dns.h - Host stand-in for the Arduino DNS client, counts the lookups
+
+*/
+
+#ifndef DNSClient_h
+#define DNSClient_h
+
+#include "IPAddress.h"
+
+class DNSClient {
+  public:
+    void begin(const IPAddress &) {}
+    int getHostByName(const char *host, IPAddress &ip);
+};
+
+#endif
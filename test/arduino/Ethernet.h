@@ -0,0 +1,19 @@
+/*
+Ethernet.h - Host stand-in for the Arduino Ethernet library
+
+*/
+
+#ifndef ethernet_h
+#define ethernet_h
+
+#include "IPAddress.h"
+#include "EthernetClient.h"
+
+class EthernetClass {
+  public:
+    IPAddress dnsServerIP() { return IPAddress(192, 168, 0, 1); }
+};
+
+extern EthernetClass Ethernet;
+
+#endif
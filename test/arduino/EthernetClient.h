@@ -0,0 +1,32 @@
+/*
+EthernetClient.h - Host stand-in for a W5100 socket, see w5100.h
+
+*/
+
+#ifndef ethernetclient_h
+#define ethernetclient_h
+
+#include "Arduino.h"
+#include "Client.h"
+
+class EthernetClient : public Client {
+  public:
+    EthernetClient() : _socket(-1) {}
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char *host, uint16_t port);
+    virtual size_t write(uint8_t b) { return write(&b, 1); }
+    virtual size_t write(const uint8_t *buf, size_t size);
+    virtual int available();
+    virtual int read();
+    virtual int read(uint8_t *buf, size_t size);
+    virtual int peek() { return -1; }
+    virtual void flush() {}
+    virtual void stop();
+    virtual uint8_t connected();
+    virtual operator bool() { return _socket >= 0; }
+    using Print::write;
+  private:
+    int _socket;
+};
+
+#endif
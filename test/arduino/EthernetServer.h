@@ -0,0 +1,4 @@
+/*
+EthernetServer.h - Host stand-in, included by Nimbits.cpp but not used
+
+*/
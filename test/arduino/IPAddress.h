@@ -0,0 +1,23 @@
+/*
+IPAddress.h - Host stand-in for the Arduino IPAddress
+
+*/
+
+#ifndef IPAddress_h
+#define IPAddress_h
+
+#include <stdint.h>
+#include <string.h>
+
+class IPAddress {
+  public:
+    IPAddress() { memset(b, 0, 4); }
+    IPAddress(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) { b[0] = b0; b[1] = b1; b[2] = b2; b[3] = b3; }
+    uint8_t operator[](int i) const { return b[i]; }
+    uint8_t &operator[](int i) { return b[i]; }
+    bool operator==(const IPAddress &o) const { return memcmp(b, o.b, 4) == 0; }
+  private:
+    uint8_t b[4];
+};
+
+#endif
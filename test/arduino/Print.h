@@ -0,0 +1,36 @@
+/*
+Print.h - Host stand-in for the Arduino Print class
+
+*/
+
+#ifndef Print_h
+#define Print_h
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+class String;
+class __FlashStringHelper;
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *b, size_t n) { size_t k = 0; while (n--) k += write(*b++); return k; }
+    size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const __FlashStringHelper *s) { return write((const char *)s); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(const String &s);
+    size_t print(int v) { return print((long)v); }
+    size_t print(unsigned int v) { return print((unsigned long)v); }
+    size_t print(long v) { char b[24]; snprintf(b, sizeof b, "%ld", v); return write(b); }
+    size_t print(unsigned long v) { char b[24]; snprintf(b, sizeof b, "%lu", v); return write(b); }
+    size_t print(double v, int d = 2) { char b[48]; snprintf(b, sizeof b, "%.*f", d, v); return write(b); }
+    size_t println(const char *s) { return print(s) + write("\r\n"); }
+    size_t println(const __FlashStringHelper *s) { return print(s) + write("\r\n"); }
+    size_t println(void) { return write("\r\n"); }
+};
+
+#endif
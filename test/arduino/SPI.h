@@ -0,0 +1,4 @@
+/*
+SPI.h - Host stand-in, included by Nimbits.cpp but not used
+
+*/
@@ -0,0 +1,4 @@
+/*
+util.h - Host stand-in, included by Nimbits.cpp but not used
+
+*/
@@ -0,0 +1,227 @@
+//******************************************************************************
+//  w5100.cpp - W5100 sockets and a scripted server for the host tests
+//
+//  Host test, built with g++
+//******************************************************************************
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "EthernetClient.h"
+#include "Ethernet.h"
+#include "Dns.h"
+#include "w5100.h"
+
+struct Socket {
+    bool open;                               // by the client
+    bool closed;                             // by the server
+    bool answer;                             // a reply or drop is pending
+    bool closeAfter;
+    const char *reply;                       // 0 = drop
+    size_t sent;                             // reply bytes read
+    unsigned long ready;                     // time of the reply
+    char in[1024];                           // request bytes not yet served
+    size_t fill;
+};
+
+struct Reply {
+    const char *text;
+    unsigned long delay;
+    bool close;
+};
+
+static Socket Sockets[W5100_SOCKETS];
+static Reply Script[W5100_SCRIPT];
+static unsigned int ScriptHead, ScriptCount;
+
+unsigned long W5100_Time;
+bool W5100_Refuse;
+unsigned int W5100_Lookups, W5100_Connects, W5100_Writes, W5100_Requests;
+char W5100_Last[1024];
+EthernetClass Ethernet;
+
+unsigned long millis(void)
+{
+    return W5100_Time;
+}
+
+void delay(unsigned long ms)
+{
+    W5100_Time += ms;
+}
+
+size_t Print::print(const String &s)
+{
+    return write(s.c_str());
+}
+
+void W5100_Reset(void)
+{
+    memset(Sockets, 0, sizeof Sockets);
+    ScriptHead = ScriptCount = 0;
+    W5100_Time = 0;
+    W5100_Refuse = false;
+    W5100_Lookups = W5100_Connects = W5100_Writes = W5100_Requests = 0;
+    W5100_Last[0] = 0;
+}
+
+void W5100_Reply(const char *text, unsigned long delay, bool close)
+{
+    Reply *r = &Script[(ScriptHead + ScriptCount++) % W5100_SCRIPT];
+
+    r->text = text;
+    r->delay = delay;
+    r->close = close;
+}
+
+void W5100_Drop(void)
+{
+    for (int i = 0; i < W5100_SOCKETS; i++)
+        Sockets[i].closed = true;
+}
+
+// Content-Length of a request head, 0 without
+static size_t Length(const char *head, size_t size)
+{
+    static const char name[] = "content-length:";
+    size_t i, k;
+
+    for (i = 0; i + sizeof name - 1 < size; i++) {
+        for (k = 0; name[k] && tolower(head[i + k]) == name[k]; k++)
+            ;
+        if (!name[k])
+            return strtoul(head + i + k, 0, 10);
+    }
+    return 0;
+}
+
+// Takes complete requests off the socket and schedules their replies.
+static void Serve(Socket *s)
+{
+    const char *end;
+    size_t size;
+    Reply *r;
+
+    while (!s->answer && (end = strstr(s->in, "\r\n\r\n"))) {
+        size = end + 4 - s->in;
+        size += Length(s->in, size);
+        if (s->fill < size)
+            return;
+        memcpy(W5100_Last, s->in, size);
+        W5100_Last[size] = 0;
+        W5100_Requests++;
+        s->fill -= size;
+        memmove(s->in, s->in + size, s->fill + 1);
+        if (ScriptCount == 0)
+            return;                          // never answered
+        r = &Script[ScriptHead];
+        ScriptHead = (ScriptHead + 1) % W5100_SCRIPT;
+        ScriptCount--;
+        s->answer = true;
+        s->reply = r->text;
+        s->sent = 0;
+        s->closeAfter = r->close;
+        s->ready = W5100_Time + r->delay;
+    }
+}
+
+// Delivers what is due, returns the reply bytes that can be read.
+static size_t Due(Socket *s)
+{
+    if (!s->answer || W5100_Time < s->ready)
+        return 0;
+    if (!s->reply || !s->reply[s->sent]) {
+        s->answer = false;
+        if (!s->reply || s->closeAfter)
+            s->closed = true;
+        Serve(s);                            // a request sent meanwhile
+        return Due(s);
+    }
+    return strlen(s->reply + s->sent);
+}
+
+int DNSClient::getHostByName(const char *host, IPAddress &ip)
+{
+    W5100_Lookups++;
+    ip = IPAddress(10, 0, 0, 1);
+    return 1;
+}
+
+int EthernetClient::connect(const char *host, uint16_t port)
+{
+    IPAddress ip;
+
+    DNSClient().getHostByName(host, ip);
+    return connect(ip, port);
+}
+
+int EthernetClient::connect(IPAddress ip, uint16_t port)
+{
+    int i;
+
+    stop();
+    if (W5100_Refuse)
+        return 0;
+    for (i = 0; i < W5100_SOCKETS && Sockets[i].open; i++)
+        ;
+    if (i == W5100_SOCKETS)
+        return 0;
+    memset(&Sockets[i], 0, sizeof Sockets[i]);
+    Sockets[i].open = true;
+    _socket = i;
+    W5100_Connects++;
+    return 1;
+}
+
+size_t EthernetClient::write(const uint8_t *buf, size_t size)
+{
+    Socket *s;
+
+    if (_socket < 0 || (s = &Sockets[_socket])->closed)
+        return 0;
+    if (s->fill + size >= sizeof s->in) {
+        fprintf(stderr, "w5100: request too long\n");
+        exit(1);
+    }
+    memcpy(s->in + s->fill, buf, size);
+    s->fill += size;
+    s->in[s->fill] = 0;
+    W5100_Writes++;
+    Serve(s);
+    return size;
+}
+
+int EthernetClient::available()
+{
+    return _socket < 0 ? 0 : Due(&Sockets[_socket]);
+}
+
+int EthernetClient::read()
+{
+    Socket *s;
+
+    if (_socket < 0 || !Due(s = &Sockets[_socket]))
+        return -1;
+    return (uint8_t)s->reply[s->sent++];
+}
+
+int EthernetClient::read(uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+    int c;
+
+    while (n < size && (c = read()) >= 0)
+        buf[n++] = c;
+    return n ? (int)n : -1;
+}
+
+void EthernetClient::stop()
+{
+    if (_socket >= 0)
+        Sockets[_socket].open = false;
+    _socket = -1;
+}
+
+uint8_t EthernetClient::connected()
+{
+    return _socket >= 0 && (available() > 0 || !Sockets[_socket].closed);
+}
@@ -0,0 +1,31 @@
+/*
+w5100.h - W5100 sockets and a scripted server for the host tests
+
+Every connect() of the library opens a socket of the model. The server
+reads whole requests from it (the head up to the blank line plus
+Content-Length bytes) and answers each with the next entry of the script
+set up by W5100_Reply(): the reply text 'delay' ms later, after which it
+closes the socket if 'close' is set. A text of 0 is a dropped request,
+the server closes after 'delay' ms without a reply. Requests beyond the
+script are never answered.
+
+millis() is W5100_Time, delay() advances it, so timeouts take no time.
+
+*/
+
+#ifndef _w5100_h
+#define _w5100_h
+
+#define W5100_SOCKETS 4
+#define W5100_SCRIPT  16
+
+void W5100_Reset(void);                      // no sockets, empty script, time 0
+void W5100_Reply(const char *text, unsigned long delay = 0, bool close = false);
+void W5100_Drop(void);                       // the server closes all sockets
+
+extern unsigned long W5100_Time;
+extern bool W5100_Refuse;                    // connect() fails
+extern unsigned int W5100_Lookups, W5100_Connects, W5100_Writes, W5100_Requests;
+extern char W5100_Last[1024];                // the last complete request
+
+#endif /* _w5100_h */
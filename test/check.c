@@ -0,0 +1,35 @@
+//******************************************************************************
+//  check.c - Minimal checks for the host tests
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "check.h"
+
+unsigned int Check_Failed = 0;
+
+void Check_Fail(const char *file, int line, const char *what)
+{
+  fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+  Check_Failed++;
+}
+
+void Check_Note(const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  vfprintf(stdout, format, args);
+  va_end(args);
+}
+
+int Check_Done(const char *name)
+{
+  if (Check_Failed)
+    fprintf(stderr, "%s: %u check(s) failed\n", name, Check_Failed);
+  else
+    fprintf(stdout, "%s: ok\n", name);   // printf() may be the firmware's
+  return Check_Failed != 0;
+}
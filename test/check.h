@@ -0,0 +1,22 @@
+/*
+check.h - Minimal checks for the host tests
+
+CHECK() reports a failed condition with file and line and counts it,
+Check_Done() prints the summary and returns the exit code for main().
+The tests of modules that include uart_tx.h can't include <stdio.h>
+(printf() is the firmware's), so output goes through these functions.
+
+*/
+
+#ifndef _check_h
+#define _check_h
+
+#define CHECK(c) ((c) ? (void)0 : Check_Fail(__FILE__, __LINE__, #c))
+
+void Check_Fail(const char *file, int line, const char *what);
+void Check_Note(const char *format, ...);    // progress or benchmark output
+int Check_Done(const char *name);            // 0 when all checks passed
+
+extern unsigned int Check_Failed;
+
+#endif /* _check_h */
@@ -0,0 +1,222 @@
+//******************************************************************************
+//  cosm_test.c - Cosm PUT and the Date: header of its reply
+//
+//  The Content-Length of the sizing pass has to match the body sent in the
+//  second pass to the byte, for every value and decimals the rows can have.
+//  The request of the transcript in Cosm_send.txt, a PUT Cosm answered with
+//  200 OK, is rebuilt from its feed and compared byte for byte. The
+//  transcript writes CR LF as "<\r><\n>" and a line end. The bytes, CPU
+//  wake-ups and modem on time of single sample PUTs are compared with one
+//  batched PUT of the same samples (modem.h).
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "cosm.h"
+#include "csv.h"
+#include "usart.h"
+#include "modem.h"
+#include "check.h"
+
+static const Cosm_Stream Streams[] = { { "0", 0 }, { "temp", 1 }, { "x", 3 } };
+static const Cosm_Feed Feed = { "116164", "key", "test", Streams, 3 };
+
+static const int *Values;                    // rows of Body()
+static unsigned int Count;
+static const Csv_Stamp *Stamp;
+static unsigned int Header;                  // bytes of the last request header
+
+static void Body(const Cosm_Feed *feed)
+{
+  unsigned int i;
+
+  for (i = 0; i < Count; i++)
+    Cosm_Row(i % feed->Count, Stamp, Values[i]);
+}
+
+// sends a PUT, returns its body and checks it against the Content-Length
+static const char *Put(const int *values, unsigned int count, const Csv_Stamp *t)
+{
+  const char *out, *body, *length;
+
+  Values = values;
+  Count = count;
+  Stamp = t;
+  Usart_Clear();
+  Cosm_Put(&Feed, Body);
+  out = Usart_Flush();
+  body = strstr(out, "\r\n\r\n");
+  length = strstr(out, "Content-Length: ");
+  CHECK(strncmp(out, "PUT /v2/feeds/116164.csv HTTP/1.1\r\n", 35) == 0);
+  CHECK(body && length && length < body);
+  if (!body || !length)
+    return "";
+  body += 4;
+  Header = body - out;
+  CHECK(strtoul(length + 16, 0, 10) == strlen(body));
+  return body;
+}
+
+static void Test_Put(void)
+{
+  static const int edge[] = { 0, 1, -1, 5, -5, 9, -9, 10, -10, 99, -99, 100, -100,
+                              999, -999, 1000, -1000, 9999, -9999, 10000, -10000,
+                              32767, -32767, -32768 };
+  static int all[3 * 64];                    // fits Usart_Out with time stamps
+  Csv_Stamp t = { 2013, 3, 8, 17 * 60 + 5 };
+  const char *body;
+  long v;
+  unsigned int i;
+
+  CHECK(strcmp(Put(edge, 6, 0), "0,0\ntemp,0.1\nx,-0.001\n0,5\ntemp,-0.5\nx,0.009") == 0);
+  CHECK(strcmp(Put(edge, 2, &t), "0,2013-03-08T17:05:00Z,0\ntemp,2013-03-08T17:05:00Z,0.1") == 0);
+  CHECK(strcmp(Put(edge, 0, &t), "") == 0);  // empty body, Content-Length: 0
+  Put(edge, sizeof edge / sizeof edge[0], 0);
+  Put(edge, sizeof edge / sizeof edge[0], &t);
+
+  for (v = -32768; v <= 32767; v += sizeof all / sizeof all[0])
+  {
+    for (i = 0; i < sizeof all / sizeof all[0]; i++)
+      all[i] = v + i > 32767 ? 32767 : v + i;
+    Put(all, sizeof all / sizeof all[0], v & 0x100 ? &t : 0);
+  }
+
+  for (i = 0; i < 32; i++)                   // a full upload queue, 16 samples
+    all[i] = 200 + i;
+  body = Put(all, 32, &t);
+  Check_Note("cosm: %u header bytes, %u body bytes for 32 stamped rows\n",
+             Header, (unsigned int)strlen(body));
+}
+
+// N samples of both streams in N PUTs or in one, a wake-up is the start
+// of the PUT plus every wait for room in the TX ring (about one per byte
+// once the ring is full)
+static void Test_Energy(void)
+{
+  static int values[2 * 16];
+  Csv_Stamp t = { 2013, 3, 8, 17 * 60 };
+  unsigned long single_bytes = 0, single_wakes = 0, batch_bytes, batch_wakes;
+  unsigned int i;
+
+  for (i = 0; i < 2 * 16; i++)
+    values[i] = 200 + i;
+  for (i = 0; i < 16; i++)
+  {
+    Put(values + 2 * i, 2, &t);
+    single_bytes += Usart_Length;
+    single_wakes += 1 + Usart_Sleeps;
+    Csv_Forward(&t, 5);
+  }
+  t.Minute = 17 * 60;
+  Put(values, 2 * 16, &t);
+  batch_bytes = Usart_Length;
+  batch_wakes = 1 + Usart_Sleeps;
+
+  Check_Note("cosm: 16 samples in 16 PUTs: %lu bytes, %lu wake-ups, modem %.0f s; "
+             "in 1 PUT: %lu bytes, %lu wake-ups, modem %.0f s\n",
+             single_bytes, single_wakes, MODEM_SECONDS(16, single_bytes),
+             batch_bytes, batch_wakes, MODEM_SECONDS(1, batch_bytes));
+  CHECK(batch_bytes < single_bytes);
+  CHECK(batch_wakes < single_wakes);
+  CHECK(MODEM_SECONDS(1, batch_bytes) < MODEM_SECONDS(16, single_bytes) / 8);
+}
+
+static void Test_Transcript(void)
+{
+  static const Cosm_Stream streams[] = { { "0", 0 } };
+  static const Cosm_Feed feed = { "116164", "t5oM-cXVCGkP-Rbb3m8xa8Avwc-SAKxJV0l1bVUvaEdoTT0g",
+                                  "Datalogger_One", streams, 1 };
+  static const int value = 25;
+  static char text[1024];
+  FILE *f = fopen("../Cosm_send.txt", "r");
+  char line[128], *put, *end, *crlf;
+
+  CHECK(f != 0);
+  if (!f)
+    return;
+  while (fgets(line, sizeof line, f) && strlen(text) + strlen(line) < sizeof text)
+  {
+    crlf = strstr(line, "<\\r><\\n>\n");
+    if (crlf)
+      strcpy(crlf, "\r\n");
+    strcat(text, line);
+  }
+  fclose(f);
+  put = strstr(text, "PUT ");
+  end = put ? strstr(put, "\r\n\r\n") : 0;
+  CHECK(put && end);
+  if (!put || !end)
+    return;
+  end += 4 + strtoul(strstr(put, "Content-Length: ") + 16, 0, 10);
+  *end = 0;                                  // request line, headers and body
+
+  Values = &value;
+  Count = 1;
+  Stamp = 0;
+  Usart_Clear();
+  Cosm_Put(&feed, Body);
+  CHECK(strcmp(Usart_Flush(), put) == 0);
+}
+
+static unsigned char Receive(const char *s)
+{
+  unsigned char found = 0;
+
+  while (*s)
+    found += Cosm_Receive(*s++);
+  return found;
+}
+
+static unsigned char Same(const Csv_Stamp *t, int year, unsigned char month,
+                          unsigned char day, unsigned int minute)
+{
+  return t->Year == year && t->Month == month && t->Day == day && t->Minute == minute;
+}
+
+static void Test_HttpDate(void)
+{
+  Csv_Stamp t = { 1, 1, 1, 1 };
+
+  CHECK(Csv_HttpDate(&t, "Sun, 06 Nov 1994 08:49:37 GMT") && Same(&t, 1994, 11, 6, 8 * 60 + 49));
+  CHECK(Csv_HttpDate(&t, "Thu, 29 Feb 2024 23:59:59 GMT") && Same(&t, 2024, 2, 29, 1439));
+  CHECK(Csv_HttpDate(&t, "Mon, 01 Jan 2024 00:00:00 GMT") && Same(&t, 2024, 1, 1, 0));
+
+  t.Year = 7;                                // rejected texts leave t alone
+  CHECK(!Csv_HttpDate(&t, "Wed, 29 Feb 2023 10:00:00 GMT"));
+  CHECK(!Csv_HttpDate(&t, "Wed, 01 Foo 2023 10:00:00 GMT"));
+  CHECK(!Csv_HttpDate(&t, "Wed, 01 Mar 2023 24:00:00 GMT"));
+  CHECK(!Csv_HttpDate(&t, "Wed, 1 Mar 2023 10:00:00 GMT"));
+  CHECK(!Csv_HttpDate(&t, "Wednesday, 01-Mar-23 10:00:00 GMT")); // RFC 850
+  CHECK(!Csv_HttpDate(&t, ""));
+  CHECK(t.Year == 7);
+}
+
+static void Test_Receive(void)
+{
+  Csv_Stamp t;
+
+  CHECK(!Cosm_Date(&t));                     // nothing read yet
+  CHECK(!Receive("HTTP/1.1 200 OK\r\nServer: nginx\r\nDate: soon\r\n"));
+  CHECK(!Cosm_Date(&t));
+  CHECK(Receive("Content-Type: text/plain\r\n"
+                "Date: Fri, 08 Mar 2013 17:05:09 GMT\r\n"
+                "X-Long: 0123456789012345678901234567890123456789012345678901234567890\r\n"
+                "\r\n") == 1);
+  CHECK(Cosm_Date(&t) && Same(&t, 2013, 3, 8, 17 * 60 + 5));
+  CHECK(Receive("dATE: Sat, 09 Mar 2013 17:05:09 GMT\n") == 0); // bare LF, case
+  CHECK(Receive("Date: Sat, 09 Mar 2013 17:05:09 GMT\n") == 1);
+  CHECK(Cosm_Date(&t) && Same(&t, 2013, 3, 9, 17 * 60 + 5));
+}
+
+int main(void)
+{
+  Test_Put();
+  Test_Transcript();
+  Test_Energy();
+  Test_HttpDate();
+  Test_Receive();
+  return Check_Done("cosm_test");
+}
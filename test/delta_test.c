@@ -0,0 +1,156 @@
+//******************************************************************************
+//  delta_test.c - Retention, compression and speed of the delta stream
+//
+//  Each signal is fed minute by minute into one Delta_Stream (one sensor)
+//  in History_Pack() units of 0.5 deg C. After every day the retained
+//  minutes are counted and decoded against the input.
+//
+//  "temperatures.csv" is the 2007 daily High/Low of the repository on a
+//  cosine day curve (low at 5:00, high at 15:00) plus +-0.1 deg C sensor
+//  noise, i.e. what the NTC delivers. The random walk and the noise are the
+//  bad cases; "jumps" needs the long code for every sample, the worst case
+//  the size check in delta.c is made for.
+//
+//  The ratio is against one byte per sample. Times are host times, for
+//  comparing the signals only; cycles on the F149 are not measured here.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "delta.h"
+#include "check.h"
+
+#define DAYS_MAX 400
+#define MINUTES  1440
+
+static int High[DAYS_MAX], Low[DAYS_MAX];    // deg F
+static int Days;
+static int Input[DAYS_MAX * MINUTES];
+
+static int Pack(int value)                   // as History_Pack(), 0.1 deg C
+{
+  if (value <= -400)
+    return 0;
+  if (value >= 875)
+    return 255;
+  return (value + 402) / 5;
+}
+
+static void Load(void)
+{
+  FILE *f = fopen("../temperatures.csv", "r");
+  char line[80];
+
+  CHECK(f != 0);
+  if (!f)
+    return;
+  fgets(line, sizeof line, f);               // Date,High,Low
+  while (Days < DAYS_MAX && fgets(line, sizeof line, f)
+         && sscanf(line, "%*d,%d,%d", &High[Days], &Low[Days]) == 2)
+    Days++;
+  fclose(f);
+}
+
+static int Signal(int kind, int minute)
+{
+  static int walk = 120;
+  int day = minute / MINUTES, m = minute % MINUTES;
+  double f, c;
+
+  switch (kind)
+  {
+    case 0:                                  // constant
+      return 120;
+    case 1:                                  // temperatures.csv + noise
+      f = (High[day] + Low[day]) / 2.0
+          + (High[day] - Low[day]) / 2.0 * cos((m / (double)MINUTES - 15 / 24.0) * 2 * M_PI);
+      c = (f - 32) * 50 / 9;                 // 0.1 deg C
+      return Pack((int)lround(c) + rand() % 3 - 1);
+    case 2:                                  // random walk, +-1 step every minute
+      walk += rand() & 1 ? 1 : -1;
+      if (walk < 20 || walk > 230)
+        walk = 120;
+      return walk;
+    case 3:                                  // noise, +-8 steps
+      return 120 + rand() % 17 - 8;
+    default:                                 // jumps, long code every time
+      return minute & 1 ? 20 : 230;
+  }
+}
+
+static const char * const Names[] = {
+  "constant", "temperatures.csv", "random walk", "noise +-4 deg C", "jumps"
+};
+
+int main(void)
+{
+  static Delta_Stream stream;
+  Delta_Reader r;
+  unsigned int n, i, min_count, k;
+  unsigned long sum_count, days, add_ns_count;
+  double add_ns, seek_ns;
+  clock_t start;
+  int kind, minute, minutes, ok;
+
+  Load();
+  srand(1);
+  for (kind = 0; kind < 5; kind++)
+  {
+    minutes = (kind == 1 ? Days : 30) * MINUTES;
+    for (minute = 0; minute < minutes; minute++)
+      Input[minute] = Signal(kind, minute);
+
+    Delta_Init(&stream);
+    min_count = 0xFFFF;
+    sum_count = days = 0;
+    add_ns = 0;
+    add_ns_count = 0;
+    ok = 1;
+    for (minute = 0; minute < minutes; minute += MINUTES)
+    {
+      start = clock();
+      for (k = 0; k < MINUTES; k++)
+        Delta_Add(&stream, Input[minute + k]);
+      add_ns += (clock() - start) * 1e9 / CLOCKS_PER_SEC;
+      add_ns_count += MINUTES;
+
+      n = Delta_Count(&stream);             // the last n inputs, oldest first
+      if (n < min_count)
+        min_count = n;
+      sum_count += n;
+      days++;
+      if (Delta_Seek(&r, &stream, 0) != Input[minute + MINUTES - n])
+        ok = 0;
+      for (i = 1; i < n; i++)
+        if (Delta_Next(&r) != Input[minute + MINUTES - n + i])
+          ok = 0;
+    }
+    CHECK(ok);
+
+    start = clock();                         // random access, as History_Get() does
+    for (k = 0; k < 10000; k++)
+      Delta_Seek(&r, &stream, rand() % Delta_Count(&stream));
+    seek_ns = (clock() - start) * 1e9 / CLOCKS_PER_SEC / 10000;
+
+    Check_Note("delta %-17s %4u..%4lu minutes kept (%4.1f h), %.2f bytes/sample, "
+               "ratio %4.1f, %3.0f ns/add, %4.0f ns/seek (host)\n",
+               Names[kind], min_count, sum_count / days, min_count / 60.0,
+               DELTA_BYTES / (double)min_count, min_count / (double)DELTA_BYTES,
+               add_ns / add_ns_count, seek_ns);
+
+    switch (kind)                            // the retention of each signal
+    {
+      case 0: CHECK(min_count >= MINUTES); break;
+      case 1: CHECK(min_count >= 15 * 60); break;
+      case 2: CHECK(min_count >= 7 * 60); break;
+      case 3: CHECK(min_count >= 3 * 60); break;
+      case 4: CHECK(min_count >= DELTA_KEYFRAME); break;
+    }
+  }
+  return Check_Done("delta_test");
+}
@@ -0,0 +1,157 @@
+//******************************************************************************
+//  format_test.c - format.c against snprintf() and the old ltoa_format()
+//
+//  All 16 bit values are checked. The benchmark counts what is expensive
+//  on the F149, which has no divider: Old_Format() (ltoa_format() from
+//  main.c before format.c) needs a 32 bit software division per digit,
+//  format.c one hardware multiplication per two digits. Host run times
+//  would say nothing about that, so the operations are counted.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <msp430x14x.h>
+#include "format.h"
+#include "check.h"
+
+void sendByte(unsigned char byte);
+
+static char Out[32];
+static unsigned int OutLen;
+static unsigned long Divisions;
+
+void sendByte(unsigned char byte)
+{
+  if (OutLen < sizeof Out - 1)
+    Out[OutLen++] = byte;
+  Out[OutLen] = 0;
+}
+
+static const char *Sent(void)
+{
+  OutLen = 0;
+  return Out;
+}
+
+// ltoa_format() as it was in main.c, the divisions counted
+static int Old_Format(char *erg, long zahl, unsigned int vk, unsigned int nk)
+{ // Out-String, input long, pre-decimal digits, decimal digits, sign '+' or ' '
+  char vorz = ' ';
+  long temp;
+   int  i;
+   i = vk + nk + 1;                   	// string length
+   erg[i--] = 0;                      	// string end
+   if ( zahl == 0 )						// special case input = 0
+   {
+      while( i >= 0 &&
+	       ( zahl > 0 || i+2*( nk != 0 ) >= vk) ) // vk contain sign
+	   	{
+	      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed
+	      else erg[i--] = '0'; // detach digit, value = 0
+	  	}
+      if ( i >= 0 ) erg[i--] = vorz;      	// write sign
+    }
+   else
+   {
+      if ( zahl < 0 )
+      {
+      vorz  = '-';                     // sign = '-'
+      zahl *=  -1;                     // calculate further with positive value
+      }
+      while( i >= 0 &&
+	       ( zahl > 0 || i+2*( nk != 0 ) > vk) ) // vk contain sign
+      {
+      if (i==vk&&nk!=0) erg[i--]='.';  // decimal point, if nk is executed
+      else
+      {
+      temp     =  zahl / 10;           	// integer division
+      Divisions++;
+      erg[i--] = (zahl - temp*10) + 48; // detach digit, assign ASCII-value
+      zahl     =  temp;                	// for next pass reduce digit
+      }
+   	  }
+   if ( i >= 0 ) erg[i--] = vorz;      	// write sign
+   }
+   while( i >= 0 ) erg[i--] = ' ';     	// fill begin with spaces
+   return  vk + nk + 1;                	// return string length
+}
+
+static void Check_Values(void)
+{
+  char expect[16];
+  long v;
+  unsigned char d;
+
+  for (v = 0; v <= 65535; v++)
+  {
+    snprintf(expect, sizeof expect, "%lu", v);
+    Sent();
+    CHECK(Format_Unsigned(v) == strlen(expect));
+    CHECK(strcmp(Out, expect) == 0);
+    CHECK(Format_Length(v) == strlen(expect));
+
+    snprintf(expect, sizeof expect, "%07lu", v);
+    Sent();
+    CHECK(Format_Width(v, 7, '0') == 7);
+    CHECK(strcmp(Out, expect) == 0);
+  }
+  for (v = -32768; v <= 32767; v++)
+  {
+    snprintf(expect, sizeof expect, "%ld", v);
+    Sent();
+    CHECK(Format_Signed(v) == strlen(expect));
+    CHECK(strcmp(Out, expect) == 0);
+
+    for (d = 0; d <= 8; d++)                 // more decimals than digits, too
+    {
+      static const long Scale[] = { 1, 10, 100, 1000, 10000, 100000, 1000000,
+                                    10000000, 100000000 };
+      long whole = (v < 0 ? -v : v) / Scale[d], part = (v < 0 ? -v : v) % Scale[d];
+
+      if (d)
+        snprintf(expect, sizeof expect, "%s%ld.%0*ld", v < 0 ? "-" : "", whole, d, part);
+      else
+        snprintf(expect, sizeof expect, "%ld", v);
+      Sent();
+      CHECK(Format_Fixed(v, d) == strlen(expect));
+      CHECK(strcmp(Out, expect) == 0);
+    }
+  }
+}
+
+// temperatures as in a Cosm row, -40.0..99.9 deg C
+static void Benchmark(void)
+{
+  char buffer[16];
+  unsigned long calls = 0;
+  int v;
+
+  Divisions = 0;
+  Sim_Multiplies = 0;
+  for (v = -400; v < 1000; v++, calls++)
+  {
+    Old_Format(buffer, v, 3, 1);
+    Sent();
+    Format_Fixed(v, 1);
+  }
+  CHECK(Sim_Multiplies * 3 <= Divisions);
+  Check_Note("format: per value %.2f 32 bit software divisions (ltoa_format) "
+             "vs %.2f hardware multiplications\n",
+             (double)Divisions / calls, (double)Sim_Multiplies / calls);
+}
+
+int main(void)
+{
+  char buffer[16];
+
+  Old_Format(buffer, -235, 3, 1);            // same digits as the old code
+  CHECK(strcmp(buffer, "-23.5") == 0);
+  Old_Format(buffer, 5, 3, 1);
+  CHECK(strcmp(buffer, "  0.5") == 0);
+
+  Check_Values();
+  Benchmark();
+  return Check_Done("format_test");
+}
@@ -0,0 +1,112 @@
+//******************************************************************************
+//  history_test.c - Tiers and spans of history.c
+//
+//  Eight days of minute samples go in, a noisy signal on one sensor and
+//  jumps over the whole range on the other, so no tier can get by on
+//  compression. Every entry of every tier is then compared with the min,
+//  avg and max of the input minutes it covers.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdlib.h>
+#include "history.h"
+#include "check.h"
+
+#define DAYS    8
+#define MINUTES (DAYS * 1440)
+
+static unsigned char Input[MINUTES][HISTORY_SENSORS]; // History_Pack() format
+
+static int Value(unsigned char sensor, unsigned int minute)
+{
+  if (sensor == 0)
+    return 200 + (int)(minute % 1440) / 4 + rand() % 21 - 10;
+  return minute & 1 ? -400 : 875;
+}
+
+// compares entry i of a tier with the last 'span' minutes it covers
+static unsigned char Same(unsigned char tier, unsigned int span, unsigned int i)
+{
+  unsigned int n = History_Count(tier), first, k, sum;
+  unsigned char s, min, max, avg, ok = 1;
+  History_Point p;
+
+  first = MINUTES - (MINUTES % span) - (n - i) * span;
+  for (s = 0; s < HISTORY_SENSORS; s++)
+  {
+    sum = 0;
+    min = 255;
+    max = 0;
+    for (k = first; k < first + span; k++)
+    {
+      sum += Input[k][s];
+      if (Input[k][s] < min)
+        min = Input[k][s];
+      if (Input[k][s] > max)
+        max = Input[k][s];
+    }
+    avg = (sum + span / 2) / span;
+    History_Get(tier, s, i, &p);
+    if (p.Avg != History_Unpack(avg))
+      ok = 0;
+    if (max - avg <= 15 && p.Max != History_Unpack(max))
+      ok = 0;
+    if (avg - min <= 15 && p.Min != History_Unpack(min))
+      ok = 0;
+  }
+  return ok;
+}
+
+int main(void)
+{
+  int values[HISTORY_SENSORS];
+  unsigned int minute, i;
+  unsigned char s, ok;
+
+  CHECK(History_Count(HISTORY_MINUTE) == 0);
+  CHECK(History_Count(HISTORY_QUARTER) == 0);
+  CHECK(History_Count(HISTORY_HOUR) == 0);
+
+  srand(1);
+  for (minute = 0; minute < MINUTES; minute++)
+  {
+    for (s = 0; s < HISTORY_SENSORS; s++)
+    {
+      values[s] = Value(s, minute);
+      Input[minute][s] = History_Pack(values[s]);
+    }
+    History_Add(values);
+    if (minute == 14)
+      CHECK(History_Count(HISTORY_QUARTER) == 1);
+    if (minute == 59)
+    {
+      CHECK(History_Count(HISTORY_MINUTE) == 60);
+      CHECK(History_Count(HISTORY_QUARTER) == 4);
+      CHECK(History_Count(HISTORY_HOUR) == 1);
+    }
+  }
+  CHECK(History_Samples == MINUTES);
+  CHECK(History_Count(HISTORY_MINUTE) == HISTORY_MINUTES);
+  CHECK(History_Count(HISTORY_QUARTER) == HISTORY_QUARTERS);
+  CHECK(History_Count(HISTORY_HOUR) == HISTORY_HOURS);
+
+  ok = 1;
+  for (i = 0; i < HISTORY_MINUTES; i++)
+    if (!Same(HISTORY_MINUTE, 1, i))
+      ok = 0;
+  CHECK(ok);
+  for (i = 0; i < HISTORY_QUARTERS; i++)
+    if (!Same(HISTORY_QUARTER, 15, i))
+      ok = 0;
+  CHECK(ok);
+  for (i = 0; i < HISTORY_HOURS; i++)
+    if (!Same(HISTORY_HOUR, 60, i))
+      ok = 0;
+  CHECK(ok);
+
+  Check_Note("history: %u minutes, %u quarters (%u h), %u hours (%u days) of any signal\n",
+             HISTORY_MINUTES, HISTORY_QUARTERS, HISTORY_QUARTERS / 4,
+             HISTORY_HOURS, HISTORY_HOURS / 24);
+  return Check_Done("history_test");
+}
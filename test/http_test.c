@@ -0,0 +1,104 @@
+//******************************************************************************
+//  http_test.c - Response framing of http.c for HTTP/1.0, 1.1 and HEAD
+//
+//  The requests go through the real parser, the responses through the
+//  real TX ring (usart.c).
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <string.h>
+#include "uart_tx.h"
+#include "request.h"
+#include "http.h"
+#include "usart.h"
+#include "check.h"
+
+static const char Page[] = "<html>static</html>";
+
+static Request *Parse(const char *s)
+{
+  while (*s)
+    Request_Byte(*s++);
+  return Request_Get();
+}
+
+// a streamed page of 'n' bytes
+static void Stream(unsigned int n)
+{
+  Http_BeginChunked("text/csv");
+  while (n--)
+    sendByte('0' + n % 10);
+  Http_EndChunked();
+}
+
+// response to 'request' with the handler 'page', returns the body
+static const char *Respond(const char *request, unsigned char page)
+{
+  Request *r = Parse(request);
+  const char *body;
+
+  CHECK(r != 0);
+  Usart_Clear();
+  Http_Begin(r);
+  if (page)
+    Stream(200);
+  else
+    Http_Static(r, "text/html", "\"1\"", Page, sizeof Page - 1);
+  Http_End();
+  Request_Release();
+  Usart_Flush();
+  body = strstr(Usart_Out, "\r\n\r\n");
+  CHECK(body != 0);
+  return body ? body + 4 : "";
+}
+
+static unsigned char Header(const char *name)
+{
+  const char *end = strstr(Usart_Out, "\r\n\r\n");
+  const char *h = strstr(Usart_Out, name);
+
+  return h && end && h < end;
+}
+
+int main(void)
+{
+  char data[1024];
+  const char *body;
+
+  body = Respond("GET /data.csv HTTP/1.1\r\nHost: x\r\n\r\n", 1);
+  CHECK(Header("Transfer-Encoding: chunked"));
+  CHECK(!Header("Connection: close"));
+  CHECK(Usart_Dechunk(body, data) == 200);
+
+  body = Respond("GET /data.csv HTTP/1.0\r\n\r\n", 1);
+  CHECK(!Header("Transfer-Encoding"));       // no chunks for 1.0 ...
+  CHECK(Header("Connection: close"));        // ... the body ends with the connection
+  CHECK(strlen(body) == 200);
+
+  body = Respond("GET /data.csv HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", 1);
+  CHECK(!Header("Transfer-Encoding"));
+  CHECK(Header("Connection: close"));
+  CHECK(strlen(body) == 200);
+
+  body = Respond("HEAD /data.csv HTTP/1.1\r\n\r\n", 1);
+  CHECK(Header("Transfer-Encoding: chunked")); // same headers as GET
+  CHECK(*body == 0);                         // but no body, not even the last chunk
+
+  body = Respond("HEAD / HTTP/1.1\r\n\r\n", 0);
+  CHECK(Header("Content-Length: 19"));
+  CHECK(*body == 0);
+
+  body = Respond("GET / HTTP/1.1\r\n\r\n", 0);
+  CHECK(strcmp(body, Page) == 0);
+
+  Usart_Clear();                             // no request: as before, HTTP/1.1 GET
+  Http_Begin(0);
+  Stream(10);
+  Http_End();
+  Usart_Flush();
+  CHECK(Header("Transfer-Encoding: chunked"));
+  CHECK(Usart_Dechunk(strstr(Usart_Out, "\r\n\r\n") + 4, data) == 10);
+
+  return Check_Done("http_test");
+}
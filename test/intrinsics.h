@@ -0,0 +1,19 @@
+/*
+intrinsics.h - Host stand-in for the IAR intrinsics, test builds only
+
+*/
+
+#ifndef _host_intrinsics_h
+#define _host_intrinsics_h
+
+#include <msp430x14x.h>
+
+typedef unsigned short __istate_t;
+
+#define __get_interrupt_state()  (Sim_SR & GIE)
+#define __set_interrupt_state(s) (Sim_SR = (Sim_SR & ~GIE) | (s))
+#define __disable_interrupt()    (Sim_SR &= ~GIE)
+#define __enable_interrupt()     (Sim_SR |= GIE)
+#define __no_operation()         ((void)0)
+
+#endif /* _host_intrinsics_h */
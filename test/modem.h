@@ -0,0 +1,20 @@
+/*
+modem.h - On time model of the modem for the host tests
+
+The modem is on while it connects, sends the request and waits for the
+reply. There is no measurement of the module, so the tests count a fixed
+MODEM_PUT_S per request plus the bytes at the 9600 baud of USART0
+(main.c). Comparisons of two upload schemes hold for any positive cost.
+
+*/
+
+#ifndef _modem_h
+#define _modem_h
+
+#define MODEM_BYTES_PER_S 960                // 9600 baud, 8N1
+#define MODEM_PUT_S       5                  // connect, reply and hang up
+
+// seconds the modem is on for 'puts' requests of 'bytes' in total
+#define MODEM_SECONDS(puts, bytes) ((puts) * (double)MODEM_PUT_S + (bytes) / (double)MODEM_BYTES_PER_S)
+
+#endif /* _modem_h */
@@ -0,0 +1,124 @@
+/*
+msp430x14x.h - Host stand-in for the IAR device header, test builds only
+
+The peripheral registers used by the firmware are plain variables
+(sim.c), the intrinsics go through Sim_SR. _BIS_SR() with LPM bits calls
+Sim_Sleep(), where a test plays the interrupts that would wake the CPU.
+
+*/
+
+#ifndef _host_msp430x14x_h
+#define _host_msp430x14x_h
+
+#define BIT0 0x01
+#define BIT1 0x02
+#define BIT2 0x04
+#define BIT3 0x08
+#define BIT4 0x10
+#define BIT5 0x20
+#define BIT6 0x40
+#define BIT7 0x80
+
+extern volatile unsigned char IFG1, IE1, ME1, UCTL0, UTCTL0, URCTL0, UBR00, UBR10, UMCTL0, RXBUF0;
+extern volatile unsigned short TXBUF0;       // wider than on chip, SIM_TX_IDLE = not written
+extern volatile unsigned char P1OUT, P1DIR, P1SEL, P1IN, P2OUT, P2DIR, P2SEL, P2IN;
+extern volatile unsigned char P3OUT, P3DIR, P3SEL, P3IN, P6OUT, P6DIR, P6SEL;
+extern volatile unsigned short WDTCTL, ADC12CTL0, ADC12CTL1, ADC12IFG, ADC12IE, ADC12IV;
+extern volatile unsigned short ADC12MEM[16];
+extern volatile unsigned char ADC12MCTL[16];
+extern volatile unsigned short FCTL1, FCTL2, FCTL3;
+extern volatile unsigned short TACTL, TACCTL0, TACCTL1, TACCR0, TACCR1;
+
+// TAR counts while the CPU runs: after Sim_TarAfter accesses it moves on
+// by Sim_TarJump ticks once, without setting any flag (0 = never)
+extern unsigned char Sim_TarAfter;
+extern unsigned short Sim_TarJump;
+volatile unsigned short *Sim_TAR(void);
+#define TAR (*Sim_TAR())
+
+// hardware multiplier, the product is formed (and counted) when the
+// result is read
+extern volatile unsigned short MPY, OP2;
+extern unsigned long Sim_Multiplies;
+#define RESLO ((unsigned short)(Sim_Multiplies++, (unsigned long)MPY * OP2))
+#define RESHI ((unsigned short)(Sim_Multiplies++, ((unsigned long)MPY * OP2) >> 16))
+
+// reading TAIV returns and clears the highest pending Timer_A flag
+unsigned short Sim_TAIV(void);
+#define TAIV Sim_TAIV()
+
+#define UTXIFG0 0x80
+#define URXIFG0 0x40
+#define UTXIE0  0x80
+#define URXIE0  0x40
+#define UTXE0   0x80
+#define URXE0   0x40
+#define UTXIFG1 0x20
+#define WDTIE   0x01
+#define CHAR    0x10
+#define SWRST   0x01
+#define SSEL0   0x10
+#define TXEPT   0x01
+
+#define WDTPW   0x5A00
+#define WDTHOLD 0x0080
+#define WDT_ADLY_1000 (WDTPW + 0x1C)
+
+#define ADC12ON     0x0010
+#define REFON       0x0020
+#define MSC         0x0080
+#define SHT0_8      0x0800
+#define ENC         0x0002
+#define ADC12SC     0x0001
+#define ADC12BUSY   0x0001
+#define SHP         0x0200
+#define CONSEQ_1    0x0002
+#define ADC12SSEL_1 0x0008
+#define SREF_0      0x00
+#define SREF_1      0x10
+#define EOS         0x80
+#define INCH_0      0
+#define INCH_10     10
+
+#define FWKEY   0xA500
+#define ERASE   0x0002
+#define WRT     0x0040
+#define LOCK    0x0010
+#define BUSY    0x0001
+#define FSSEL_1 0x0040
+#define FN0     0x0001
+
+#define TASSEL_1 0x0100
+#define ID_3     0x00C0
+#define MC_2     0x0020
+#define TACLR    0x0004
+#define TAIE     0x0002
+#define TAIFG    0x0001
+#define CCIE     0x0010
+#define CCIFG    0x0001
+
+#define GIE       0x0008
+#define LPM0_bits 0x0010
+#define LPM3_bits 0x00D0
+
+#define USART0TX_VECTOR 0
+#define USART0RX_VECTOR 1
+#define WDT_VECTOR      2
+#define ADC12_VECTOR    3
+#define TIMERA0_VECTOR  4
+#define TIMERA1_VECTOR  5
+
+#define __interrupt
+#define __no_init
+#define __ramfunc
+
+#define SIM_TX_IDLE 0x100
+
+extern volatile unsigned short Sim_SR;       // status register, only GIE is used
+extern volatile unsigned short Sim_Wake;     // LPM bits cleared by ISRs
+void Sim_Sleep(unsigned short bits);         // provided by the test
+
+#define _BIS_SR(x)     Sim_Sleep(x)
+#define _BIC_SR_IRQ(x) (Sim_Wake |= (x))
+
+#endif /* _host_msp430x14x_h */
@@ -0,0 +1,309 @@
+//******************************************************************************
+//  nimbits_test.cpp - Nimbits client against the scripted server of w5100.cpp
+//
+//  The server answers late, never or closes without a reply; requests in
+//  flight must finish by their deadline while loop() keeps running. The
+//  cache is checked through its TTL, stale window and invalidation, the
+//  kept connections and the DNS TTL against the requests, connects and
+//  lookups the server saw.
+//
+//  Host test, built with g++
+//******************************************************************************
+
+#include "Nimbits.h"
+#include "w5100.h"
+#include "check.h"
+
+#define OK_EMPTY "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n"
+#define OK_VALUE "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\n|23.5|"
+#define VALUE(v) "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n\r\n|" v "|"
+
+// the form of the last request, and whether its Content-Length matches
+static const char *Form(void)
+{
+    const char *body = strstr(W5100_Last, "\r\n\r\n");
+    const char *length = strstr(W5100_Last, "Content-Length: ");
+
+    CHECK(body && length);
+    if (!body || !length)
+        return "";
+    body += 4;
+    CHECK(strtoul(length + 16, 0, 10) == strlen(body));
+    return body;
+}
+
+static void Test_Batch(void)
+{
+    Nimbits n("nimbits1", "me@example.com", "secret");
+    Nimbits::Point points[] = { { "temp", 21.5f }, { "hum", 40.25f }, { "door", -1 } };
+
+    W5100_Reset();
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.recordValues(points, 3));
+    CHECK(W5100_Requests == 1);              // one request for all points
+    CHECK(strncmp(W5100_Last, "POST /service/batch HTTP/1.1\r\n", 30) == 0);
+    CHECK(strcmp(Form(), "email=me@example.com&key=secret"
+                         "&p1=temp&v1=21.50000&p2=hum&v2=40.25000&p3=door&v3=-1.00000") == 0);
+    CHECK(n.recordValues(points, 0));        // nothing to send
+    CHECK(W5100_Requests == 1);
+
+    W5100_Reply(OK_EMPTY);                   // kept connection
+    CHECK(n.postValue("temp", 1));
+    CHECK(W5100_Connects == 1 && n.stats().reused == 1);
+    CHECK(strcmp(Form(), "email=me@example.com&key=secret"
+                         "&value=1.00000&point=temp") == 0);
+
+    W5100_Reply(OK_EMPTY);                   // the String API as before
+    CHECK(strcmp(n.recordValue("temp", 2).c_str(), Form()) == 0);
+    W5100_Reply(OK_EMPTY);
+    CHECK(strcmp(n.recordValue(String("temp"), 2).c_str(), Form()) == 0);
+}
+
+// only a 2xx reply is stored as success or as a value
+static void Test_Status(void)
+{
+    Nimbits n("nimbits1", "me@example.com", "secret");
+    Nimbits::Point points[] = { { "temp", 21.5f } };
+
+    W5100_Reset();
+    n.cache("temp", 60000);
+    W5100_Reply("HTTP/1.1 500 Internal Server Error\r\nContent-Length: 6\r\n\r\n|66.6|");
+    CHECK(n.getValue("temp") == -1);
+    W5100_Reply("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+    CHECK(!n.recordValues(points, 1));
+    W5100_Reply("HTTP/1.1 503 Service Unavailable\r\n\r\n|7|", 0, true);
+    CHECK(!n.postValue("temp", 1));
+    CHECK(strcmp(n.recordValue("temp", 1).c_str(), "") == 0);  // not answered
+    W5100_Reply("HTTP/1.1 302 Found\r\nContent-Length: 3\r\n\r\n|1|");
+    CHECK(n.getTime() == -1);
+    W5100_Reply("garbage\r\n\r\n|5|", 0, true);
+    CHECK(n.getValue("temp") == -1);
+
+    W5100_Reply(OK_VALUE);                   // the cache holds only a 2xx value
+    CHECK(n.getValue("temp") == 23.5f);
+    CHECK(n.getValue("temp") == 23.5f);
+    CHECK(n.stats().hits == 1);
+    W5100_Reply("HTTP/1.1 204 No Content\r\n\r\n", 0, true);
+    CHECK(n.postValue("temp", 3));
+}
+
+static uint8_t Done[8];                      // callback order: id, status, at
+static uint8_t Status[8];
+static unsigned long At[8];
+static char Value[8][NIMBITS_VALUE_SIZE];
+static uint8_t Calls;
+
+static void Finished(uint8_t id, uint8_t status, const char *value)
+{
+    Done[Calls] = id;
+    Status[Calls] = status;
+    At[Calls] = millis();
+    strcpy(Value[Calls], value);
+    Calls++;
+}
+
+// runs loop() with poll() for 'ms'
+static void Loop(unsigned long ms, Nimbits &n)
+{
+    unsigned long start = millis();
+
+    while (millis() - start < ms) {
+        n.poll();
+        delay(1);
+    }
+}
+
+// requests in flight while loop() goes on, with slow, silent and closing servers
+static void Test_Async(void)
+{
+    Nimbits n("nimbits1", "me@example.com", "secret");
+    int8_t get, post;
+    unsigned long start;
+
+    W5100_Reset();
+    Calls = 0;
+    W5100_Reply(OK_VALUE, 300);              // slow
+    W5100_Reply(OK_EMPTY, 20);
+    get = n.getValueAsync("temp", Finished);
+    post = n.recordValueAsync("temp", 5, Finished);
+    CHECK(get >= 0 && post >= 0 && get != post);
+    CHECK(n.pending() == 2);
+    CHECK(n.getTimeAsync(Finished) == -1);   // both slots busy
+    Loop(100, n);
+    CHECK(Calls == 1 && Done[0] == post && Status[0] == NIMBITS_OK && Value[0][0] == 0);
+    CHECK(At[0] >= 20 && At[0] < 25);
+    Loop(300, n);
+    CHECK(Calls == 2 && Done[1] == get && Status[1] == NIMBITS_OK && strcmp(Value[1], "23.5") == 0);
+    CHECK(n.pending() == 0);
+
+    start = millis();
+    W5100_Reply(OK_VALUE, 10000);            // silent past the deadline
+    get = n.getValueAsync("temp", Finished, 500);
+    W5100_Reply(0, 50);                      // closes without a reply
+    post = n.recordValueAsync("temp", 6, Finished);
+    Loop(1000, n);
+    CHECK(Calls == 4);
+    CHECK(Done[2] == post && Status[2] == NIMBITS_CLOSED && At[2] - start >= 50 && At[2] - start < 55);
+    CHECK(Done[3] == get && Status[3] == NIMBITS_EXPIRED && At[3] - start >= 500 && At[3] - start < 505);
+
+    W5100_Drop();                            // kept connections closed by the server
+    W5100_Reply("HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\n|42|");
+    CHECK(n.getTime() == 42);
+
+    start = millis();                        // blocking calls give up at the deadline
+    CHECK(n.getValue("temp") == -1);
+    CHECK(millis() - start >= NIMBITS_TIMEOUT && millis() - start < NIMBITS_TIMEOUT + 10);
+
+    W5100_Refuse = true;                     // no connection at all
+    CHECK(n.recordValueAsync("temp", 7, Finished) == -1);
+    CHECK(!n.postValue("temp", 7));
+    W5100_Refuse = false;
+    CHECK(Calls == 4);
+}
+
+// account strings that don't fit are rejected, not cut
+static void Test_Account(void)
+{
+    char email[NIMBITS_EMAIL_SIZE + 1];
+    Nimbits::Point points[] = { { "temp", 1 } };
+
+    CHECK(NIMBITS_KEY_SIZE == NIMBITS_EMAIL_SIZE);
+    memset(email, 'm', sizeof email - 1);
+    email[sizeof email - 1] = 0;             // one too long
+    W5100_Reset();
+    Nimbits n("nimbits1", email, "secret");
+    CHECK(!n.valid());
+    CHECK(!n.postValue("temp", 1) && !n.recordValues(points, 1));
+    CHECK(n.getValue("temp") == -1 && n.getTime() == -1);
+    CHECK(n.getValueAsync("temp", 0) == -1);
+    CHECK(W5100_Connects == 0 && W5100_Requests == 0);
+
+    email[sizeof email - 2] = 0;             // fits exactly
+    Nimbits m("nimbits1", email, "secret");
+    CHECK(m.valid());
+    W5100_Reply(OK_EMPTY);
+    CHECK(m.postValue("temp", 1));
+    CHECK(strstr(Form(), email) != 0);
+    CHECK(!Nimbits("nimbits1-0123456789abcdef", "me@example.com", "secret").valid());
+    String key(email);                       // NIMBITS_KEY_SIZE long
+    key += 'k';
+    CHECK(!Nimbits(String("nimbits1"), String("me@example.com"), key).valid());
+}
+
+// ttl 1000 ms, stale 500 ms
+static void Test_Cache(void)
+{
+    Nimbits n("nimbits1", "me@example.com", "secret");
+
+    W5100_Reset();
+    CHECK(n.cache("temp", 1000, 500));
+    W5100_Reply(OK_VALUE);
+    CHECK(n.getValue("temp") == 23.5f);      // empty entry, fetched
+    CHECK(W5100_Requests == 1 && n.stats().misses == 1 && n.stats().hits == 0);
+
+    delay(999);                              // fresh
+    CHECK(n.getValue("temp") == 23.5f);
+    CHECK(W5100_Requests == 1 && n.stats().hits == 1);
+
+    delay(1);                                // expired: old value, refresh behind
+    W5100_Reply(VALUE("24.5"), 50);
+    CHECK(n.getValue("temp") == 23.5f);
+    CHECK(W5100_Requests == 2 && n.stats().stale == 1 && n.pending() == 1);
+    CHECK(strncmp(W5100_Last, "GET /service/value?", 19) == 0);
+    CHECK(n.getValue("temp") == 23.5f);      // one refresh at a time
+    CHECK(W5100_Requests == 2 && n.stats().stale == 2);
+    Loop(60, n);
+    CHECK(n.pending() == 0);
+    CHECK(n.getValue("temp") == 24.5f);      // refreshed, fresh again
+    CHECK(W5100_Requests == 2 && n.stats().hits == 4 && n.stats().stale == 2);
+
+    delay(1500);                             // past the stale window: blocking
+    W5100_Reply(VALUE("25.0"));
+    CHECK(n.getValue("temp") == 25.0f);
+    CHECK(W5100_Requests == 3 && n.stats().misses == 2);
+
+    W5100_Reply(OK_EMPTY);                   // a write invalidates
+    CHECK(n.postValue("temp", 26));
+    W5100_Reply(VALUE("26.0"));
+    CHECK(n.getValue("temp") == 26.0f);
+    CHECK(W5100_Requests == 5 && n.stats().misses == 3);
+
+    delay(1200);                             // a write drops the refresh in flight
+    W5100_Reply(VALUE("11.1"), 100);
+    CHECK(n.getValue("temp") == 26.0f && W5100_Requests == 6);
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.recordValueAsync("temp", 27) >= 0);
+    Loop(200, n);
+    W5100_Reply(VALUE("27.0"));
+    CHECK(n.getValue("temp") == 27.0f);
+    CHECK(W5100_Requests == 8 && n.stats().misses == 4);
+
+    n.invalidate("temp");
+    W5100_Reply(VALUE("28.0"));
+    CHECK(n.getValue("temp") == 28.0f && W5100_Requests == 9 && n.stats().misses == 5);
+
+    W5100_Reply(VALUE("40.0"));              // not cached: always remote, not counted
+    CHECK(n.getValue("hum") == 40.0f && n.getValue("temp") == 28.0f);
+    CHECK(W5100_Requests == 10 && n.stats().misses == 5 && n.stats().hits == 6);
+}
+
+// the address is looked up once per NIMBITS_DNS_TTL, a connection is kept
+static void Test_Dns(void)
+{
+    Nimbits n("nimbits1", "me@example.com", "secret");
+
+    W5100_Reset();
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 1));
+    CHECK(W5100_Lookups == 1 && W5100_Connects == 1);
+    CHECK(n.stats().lookups == 1 && n.stats().connects == 1 && n.stats().reused == 0);
+
+    W5100_Reply(OK_EMPTY);                   // kept connection
+    CHECK(n.postValue("temp", 2));
+    CHECK(W5100_Lookups == 1 && W5100_Connects == 1 && n.stats().reused == 1);
+
+    W5100_Drop();                            // new connection, known address
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 3));
+    CHECK(W5100_Lookups == 1 && W5100_Connects == 2 && n.stats().connects == 2);
+
+    delay(NIMBITS_DNS_TTL);                  // expired, but the connection is open
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 4));
+    CHECK(W5100_Lookups == 1 && n.stats().reused == 2);
+
+    W5100_Drop();                            // a new connection looks up again
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 5));
+    CHECK(W5100_Lookups == 2 && n.stats().lookups == 2 && W5100_Connects == 3);
+
+    delay(NIMBITS_DNS_TTL - 1);              // still valid
+    W5100_Drop();
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 6));
+    CHECK(W5100_Lookups == 2 && W5100_Connects == 4);
+
+    W5100_Drop();                            // a refused connect forgets the address
+    W5100_Refuse = true;
+    CHECK(!n.postValue("temp", 7));
+    W5100_Refuse = false;
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 8));
+    CHECK(W5100_Lookups == 3 && n.stats().lookups == 3 && W5100_Connects == 5);
+
+    n.close();                               // close() drops the kept connection
+    W5100_Reply(OK_EMPTY);
+    CHECK(n.postValue("temp", 9));
+    CHECK(W5100_Connects == 6 && W5100_Lookups == 3);
+}
+
+int main(void)
+{
+    Test_Batch();
+    Test_Status();
+    Test_Async();
+    Test_Account();
+    Test_Cache();
+    Test_Dns();
+    return Check_Done("nimbits_test");
+}
@@ -0,0 +1,84 @@
+//******************************************************************************
+//  ntc_test.c - Table lookup of ntc.c against a plain linear search
+//
+//  ntc.c is included, so the checks can use Temperature_Lookup[] itself.
+//  Old_Temperature() is the whole degree lookup that ntc.c replaced: it
+//  returned the first table degree below the reading, i.e. it rounded up,
+//  from the 10 bit average.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include "../ntc.c"
+#include "check.h"
+
+static int Old_Temperature(unsigned int adc10)
+{
+  unsigned char i;
+
+  if (adc10 > Temperature_Lookup[0])
+    return TEMP_MIN_TEMP;
+  for (i = 0; i < TEMP_TABLE_SIZE; i++)
+    if (adc10 > Temperature_Lookup[i])
+      return i + TEMP_MIN_TEMP;
+  return TEMP_MAX_TEMP;
+}
+
+// bracketing entries by linear search, interpolated like ntc.c
+static int Linear(unsigned int adc)
+{
+  unsigned char i;
+  unsigned int upper, span;
+
+  if (adc >= Temperature_Lookup[0] << 2)
+    return TEMP_MIN_TEMP * 10;
+  for (i = 1; i < TEMP_TABLE_SIZE; i++)
+    if (adc >= Temperature_Lookup[i] << 2)
+    {
+      upper = Temperature_Lookup[i - 1] << 2;
+      span = upper - (Temperature_Lookup[i] << 2);
+      return (i - 1 + TEMP_MIN_TEMP) * 10 + ((upper - adc) * 10 + span / 2) / span;
+    }
+  return TEMP_MAX_TEMP * 10;
+}
+
+int main(void)
+{
+  unsigned int adc, n = 0;
+  int t, last = TEMP_MIN_TEMP * 10, shift, shift_min = 1000, shift_max = -1000;
+  long shift_sum = 0;
+  unsigned char i;
+
+  CHECK(sizeof Temperature_Lookup / sizeof Temperature_Lookup[0] >= TEMP_TABLE_SIZE);
+  CHECK(TEMP_MAX_TEMP - TEMP_MIN_TEMP + 1 == TEMP_TABLE_SIZE);
+
+  for (i = 0; i < TEMP_TABLE_SIZE; i++)     // table points are exact
+    CHECK(Temperature_GetDeciDegrees(Temperature_Lookup[i] << 2) == (i + TEMP_MIN_TEMP) * 10);
+
+  CHECK(Temperature_GetDeciDegrees(4095) == TEMP_MIN_TEMP * 10);
+  CHECK(Temperature_GetDeciDegrees(0) == TEMP_MAX_TEMP * 10);
+
+  for (adc = 4095; adc != (unsigned int)-1; adc--)
+  {
+    t = Temperature_GetDeciDegrees(adc);
+    CHECK(t == Linear(adc));
+    CHECK(t >= last);                        // falling ADC = rising temperature
+    last = t;
+    if (adc > Temperature_Lookup[0] << 2 || adc < Temperature_Lookup[TEMP_TABLE_SIZE - 1] << 2)
+      continue;
+    shift = Old_Temperature(adc >> 2) * 10 - t;
+    shift_sum += shift;
+    n++;
+    if (shift < shift_min)
+      shift_min = shift;
+    if (shift > shift_max)
+      shift_max = shift;
+  }
+  // old readings were rounded up to the next degree, and the 10 bit value
+  // lost up to 3 counts where the table is flat: never lower, < 2 deg higher
+  CHECK(shift_min >= 0 && shift_max < 20);
+  Check_Note("ntc: old - new %d..%d, mean %ld in 0.1 deg C over %u ADC values\n",
+             shift_min, shift_max, shift_sum / (long)n, n);
+
+  return Check_Done("ntc_test");
+}
@@ -0,0 +1,165 @@
+//******************************************************************************
+//  request_test.c - Incremental request parser and route dispatch
+//
+//  Requests are fed byte by byte as the RX ISR does, also several at once
+//  (pipelining), with bare LF line ends and with bodies. The dispatch checks answer
+//  through the real TX ring (usart.c).
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <string.h>
+#include "request.h"
+#include "route.h"
+#include "http.h"
+#include "usart.h"
+#include "check.h"
+
+static unsigned char Completed;
+static unsigned char Handled;
+
+static void Feed(const char *s)
+{
+  while (*s)
+    Completed += Request_Byte(*s++);
+}
+
+// the next complete request, released before the next Feed()
+static Request *Next(void)
+{
+  static unsigned char held;
+  Request *r;
+
+  if (held)
+    Request_Release();
+  r = Request_Get();
+  held = r != 0;
+  return r;
+}
+
+static void Page(Request *r)
+{
+  Handled++;
+  Http_Error("204 No Content");
+}
+
+#define HASH_LED ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_H(ROUTE_SEED, '/'), 'l'), 'e'), 'd')
+
+static Route Routes[ROUTE_SLOTS];
+
+static const char *Dispatch(const char *request)
+{
+  Request *r;
+
+  Feed(request);
+  r = Next();
+  CHECK(r != 0);
+  if (!r)
+    return "";
+  Usart_Clear();
+  Route_Dispatch(Routes, r);
+  return Usart_Flush();
+}
+
+int main(void)
+{
+  Request *r;
+
+  Feed("GET /led?3=EIN&x=1 HTTP/1.1\r\nHost: 192.168.0.102\r\nIf-None-Match: \"c1\"\r\n\r\n");
+  CHECK(Completed == 1);
+  r = Next();
+  CHECK(r && r->Method == REQUEST_GET && r->Flags == REQUEST_ETAG);
+  CHECK(r && strcmp(r->Path, "/led") == 0 && r->PathHash == HASH_LED);
+  CHECK(r && r->ParamCount == 2);
+  CHECK(r && strcmp(Request_GetParam(r, "3"), "EIN") == 0);
+  CHECK(r && strcmp(Request_GetParam(r, "x"), "1") == 0);
+  CHECK(r && Request_GetParam(r, "y") == 0);
+  CHECK(r && strcmp(r->ETag, "\"c1\"") == 0);
+  CHECK(Next() == 0);
+
+  // pipelined, bare LF, header names and Connection values in any case
+  Feed("HEAD / HTTP/1.1\nCONNECTION: Close\n\nPOST /x HTTP/1.0\nconnection: keep-alive\n\n");
+  r = Next();
+  CHECK(r && r->Method == REQUEST_HEAD && r->Flags == REQUEST_CLOSE);
+  r = Next();
+  CHECK(r && r->Method == REQUEST_POST && r->Flags == REQUEST_HTTP10); // keep-alive clears close
+  CHECK(Next() == 0);
+
+  Feed("GET / HTTP/1.0\r\n\r\n");            // 1.0 closes by default
+  r = Next();
+  CHECK(r && r->Flags == (REQUEST_HTTP10 | REQUEST_CLOSE));
+
+  Feed("GET /aaaaaaaaaaaaaaaaaaaa HTTP/1.1\r\n\r\n");
+  r = Next();
+  CHECK(r && (r->Flags & REQUEST_TRUNCATED) && strlen(r->Path) == REQUEST_PATH_SIZE - 1);
+  Feed("GET /?a=1&b=2&c=3 HTTP/1.1\r\n\r\n");  // more parameters than slots
+  r = Next();
+  CHECK(r && (r->Flags & REQUEST_TRUNCATED) && r->ParamCount == REQUEST_PARAMS);
+  Feed("GET / HTTP/1.1\r\nIf-None-Match: \"0123456789abcdef\"\r\n\r\n");
+  r = Next();
+  CHECK(r && r->Flags == 0);                 // a long ETag is only ignored
+
+  Feed("BREW / HTTP/1.1\r\n\r\n");
+  r = Next();
+  CHECK(r && r->Method == REQUEST_OTHER && r->Flags == 0);
+  Feed("GET /\r\n\r\n");                     // HTTP/0.9
+  r = Next();
+  CHECK(r && (r->Flags & REQUEST_BAD));
+  Next();
+
+  Completed = 0;                             // queue full: the third one is dropped
+  Feed("GET /1 HTTP/1.1\r\n\r\nGET /2 HTTP/1.1\r\n\r\nGET /3 HTTP/1.1\r\nA: b\r\n\r\n");
+  CHECK(Completed == REQUEST_QUEUE_SIZE && Request_Dropped == 1);
+  r = Next();
+  CHECK(r && strcmp(r->Path, "/1") == 0);
+  r = Next();
+  CHECK(r && strcmp(r->Path, "/2") == 0);
+  CHECK(Next() == 0);
+  Feed("GET /4 HTTP/1.1\r\n\r\n");           // the parser is back in step
+  r = Next();
+  CHECK(r && strcmp(r->Path, "/4") == 0);
+  Next();
+
+  // a body is skipped by its length, even when it looks like a request
+  Completed = 0;
+  Feed("POST /led HTTP/1.1\r\nContent-Length:  19 \r\n\r\nGET /body HTTP/1.1\r\n"
+       "GET /5 HTTP/1.1\r\n\r\n");
+  CHECK(Completed == 2);
+  r = Next();
+  CHECK(r && r->Method == REQUEST_POST && r->Flags == 0 && strcmp(r->Path, "/led") == 0);
+  r = Next();
+  CHECK(r && strcmp(r->Path, "/5") == 0);
+  Next();
+  Feed("POST / HTTP/1.1\r\nContent-Length: 4x\r\n\r\n");
+  r = Next();
+  CHECK(r && r->Flags == (REQUEST_BAD | REQUEST_CLOSE));
+  Feed("POST / HTTP/1.1\r\nContent-Length: 65536\r\n\r\n");
+  r = Next();
+  CHECK(r && r->Flags == (REQUEST_BAD | REQUEST_CLOSE));
+  Next();
+
+  Completed = 0;                             // the body of a dropped request too
+  Feed("GET /1 HTTP/1.1\r\n\r\nGET /2 HTTP/1.1\r\n\r\n"
+       "POST /3 HTTP/1.1\r\nConnection: close\r\ncontent-LENGTH: 8\r\n\r\nGET /x\r\n");
+  CHECK(Completed == REQUEST_QUEUE_SIZE && Request_Dropped == 2);
+  Next();
+  Next();
+  CHECK(Next() == 0);
+  Feed("GET /6 HTTP/1.1\r\n\r\n");
+  r = Next();
+  CHECK(r && strcmp(r->Path, "/6") == 0 && r->Flags == 0);
+  Next();
+
+  Routes[ROUTE_SLOT(HASH_LED)].Hash = HASH_LED;
+  Routes[ROUTE_SLOT(HASH_LED)].Handler = Page;
+  CHECK(strncmp(Dispatch("GET /led HTTP/1.1\r\n\r\n"), "HTTP/1.1 204", 12) == 0 && Handled == 1);
+  CHECK(strstr(Usart_Out, "Connection") == 0);
+  CHECK(strncmp(Dispatch("GET /led HTTP/1.1\r\nConnection: close\r\n\r\n"), "HTTP/1.1 204", 12) == 0);
+  CHECK(strstr(Usart_Out, "\r\nConnection: close\r\n") != 0);
+  CHECK(strncmp(Dispatch("GET /nothing HTTP/1.1\r\n\r\n"), "HTTP/1.1 404", 12) == 0);
+  CHECK(strncmp(Dispatch("GET /led\r\n\r\n"), "HTTP/1.1 400", 12) == 0);
+  CHECK(strncmp(Dispatch("GET /led?3=EINAUSEINAUS HTTP/1.1\r\n\r\n"), "HTTP/1.1 414", 12) == 0);
+  CHECK(Handled == 2);
+
+  return Check_Done("request_test");
+}
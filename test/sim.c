@@ -0,0 +1,51 @@
+//******************************************************************************
+//  sim.c - Registers of the host stand-in for msp430x14x.h
+//
+//  Sim_Sleep() has no default: a test that lets the firmware enter LPM
+//  must play the interrupts itself, everything else fails to link.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <msp430x14x.h>
+
+volatile unsigned char IFG1 = UTXIFG0, IE1, ME1, UCTL0 = SWRST, UTCTL0 = TXEPT, URCTL0;
+volatile unsigned char UBR00, UBR10, UMCTL0, RXBUF0;
+volatile unsigned short TXBUF0 = SIM_TX_IDLE;
+volatile unsigned char P1OUT, P1DIR, P1SEL, P1IN, P2OUT, P2DIR, P2SEL, P2IN;
+volatile unsigned char P3OUT, P3DIR, P3SEL, P3IN, P6OUT, P6DIR, P6SEL;
+volatile unsigned short WDTCTL, ADC12CTL0, ADC12CTL1, ADC12IFG, ADC12IE, ADC12IV;
+volatile unsigned short ADC12MEM[16];
+volatile unsigned char ADC12MCTL[16];
+volatile unsigned short FCTL1, FCTL2, FCTL3;
+volatile unsigned short TACTL, TACCTL0, TACCTL1, TACCR0, TACCR1;
+static volatile unsigned short Sim_Tar;
+unsigned char Sim_TarAfter;
+unsigned short Sim_TarJump;
+volatile unsigned short MPY, OP2;
+unsigned long Sim_Multiplies;
+
+volatile unsigned short Sim_SR;
+volatile unsigned short Sim_Wake;
+
+volatile unsigned short *Sim_TAR(void)
+{
+  if (Sim_TarAfter && --Sim_TarAfter == 0)
+    Sim_Tar += Sim_TarJump;
+  return &Sim_Tar;
+}
+
+unsigned short Sim_TAIV(void)
+{
+  if ((TACCTL1 & (CCIE | CCIFG)) == (CCIE | CCIFG))
+  {
+    TACCTL1 &= ~CCIFG;
+    return 2;
+  }
+  if ((TACTL & (TAIE | TAIFG)) == (TAIE | TAIFG))
+  {
+    TACTL &= ~TAIFG;
+    return 10;
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+//******************************************************************************
+//  template_test.c - Template_Send() body length against Content-Length
+//
+//  The body is everything after the blank line of the header.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include "webside.h"
+#include "usart.h"
+#include "check.h"
+
+// sends the page, returns the body length and checks the header
+static unsigned int Body(const Template *page, const int *values)
+{
+  const char *length, *body;
+
+  Usart_Clear();
+  Template_Send(page, values);
+  Usart_Flush();
+  length = strstr(Usart_Out, "Content-Length: ");
+  body = strstr(Usart_Out, "\r\n\r\n");
+  CHECK(length && body && length < body);
+  if (!length || !body)
+    return 0;
+  CHECK(strtoul(length + 16, 0, 10) == page->Length);
+  return Usart_Out + Usart_Length - (body + 4);
+}
+
+int main(void)
+{
+  static const int Values[][2] = { { 0, 0 }, { 57, 100 }, { -5, 999 }, { 1000, -32768 } };
+  static const char Slot[] = "Slot ";
+  static const Template_Part Parts[] = {
+    { Slot, SLOT_SIGNED, 3 },
+    { Slot, SLOT_FIXED1, 5 },
+    { Slot, SLOT_UNSIGNED, 2 }
+  };
+  static const Template Slots = {
+    "text/plain", 3 * TEMPLATE_TEXT(Slot) + 3 + 5 + 2, Parts, 3
+  };
+  static const int SlotValues[][3] = {
+    { 0, 0, 0 }, { -99, -9999, -1 }, { 999, 9999, 99 }, { -32768, 32767, 32767 }
+  };
+  unsigned char i;
+
+  CHECK(WebSide.Length == 1504);
+  for (i = 0; i < sizeof Values / sizeof Values[0]; i++)
+    CHECK(Body(&WebSide, Values[i]) == WebSide.Length);
+
+  for (i = 0; i < sizeof SlotValues / sizeof SlotValues[0]; i++)
+    CHECK(Body(&Slots, SlotValues[i]) == Slots.Length);
+  Body(&Slots, SlotValues[1]);               // clamped, not cut
+  CHECK(strstr(Usart_Out, "Slot -99Slot -99.9Slot 00") != 0);
+
+  return Check_Done("template_test");
+}
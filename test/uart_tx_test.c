@@ -0,0 +1,67 @@
+//******************************************************************************
+//  uart_tx_test.c - Ring buffer / TX ISR handoff of uart_tx.c on the host
+//
+//  usart.c models UTXIFG0 as on the F149, the TX ISR only runs while the
+//  producer sleeps in UartTx_Flush() or on a full ring.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <msp430x14x.h>
+#include "uart_tx.h"
+#include "usart.h"
+#include "check.h"
+
+static int Sent(const char *s)
+{
+  return Usart_Length == strlen(s) && memcmp(Usart_Out, s, Usart_Length) == 0;
+}
+
+int main(void)
+{
+  char data[sizeof Usart_Out], expect[300];
+  unsigned int i;
+
+  Sim_SR = GIE;
+
+  Usart_Clear();                                   // short message, no wait until Flush
+  printfln("HTTP/1.1 200 OK");
+  CHECK(Usart_Sleeps == 0);
+  UartTx_Flush();
+  CHECK(Sent("HTTP/1.1 200 OK\r\n"));
+  Usart_Run();                               // one more interrupt for the empty ring
+  CHECK(!(IE1 & UTXIE0));                    // ISR stopped itself
+  CHECK(!(IFG1 & UTXIFG0));                  // and UTXIFG0 is gone
+
+  Usart_Clear();                                   // so TxCommit() must restart the transfer
+  printf("second");
+  UartTx_Flush();
+  CHECK(Sent("second"));
+
+  Usart_Clear();                                   // more than the ring, producer sleeps
+  for (i = 0; i < sizeof expect - 1; i++)
+    expect[i] = 'a' + i % 26;
+  expect[i] = 0;
+  printf(expect);
+  UartTx_Flush();
+  CHECK(Usart_Sleeps > 0);
+  CHECK(Sent(expect));
+
+  Usart_Clear();                                   // chunked, several full chunks
+  UartTx_BeginChunked();
+  printf(expect);
+  UartTx_EndChunked();
+  UartTx_Flush();
+  CHECK(Usart_Dechunk(Usart_Out, data) == (int)strlen(expect));
+  CHECK(memcmp(data, expect, strlen(expect)) == 0);
+
+  Usart_Clear();                                   // empty chunked body
+  UartTx_BeginChunked();
+  UartTx_EndChunked();
+  UartTx_Flush();
+  CHECK(Sent("0\r\n\r\n"));
+
+  return Check_Done("uart_tx_test");
+}
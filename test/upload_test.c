@@ -0,0 +1,164 @@
+//******************************************************************************
+//  upload_test.c - Upload policy, queue and PUT body of upload.c
+//
+//  The policy is checked step by step with the limits of main.c, the PUTs
+//  go through the real Cosm builder and TX ring. Then a year of 5 minute
+//  samples over temperatures.csv (daily High/Low on a cosine day curve,
+//  +-0.1 deg C NTC noise) counts PUTs, rows, modem bytes and modem on time
+//  (modem.h) against the fixed interval of the old main.c: one PUT of the
+//  current values every 300 s sample, 288 PUTs a day.
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include "upload.h"
+#include "usart.h"
+#include "modem.h"
+#include "check.h"
+
+static const Cosm_Stream Streams[UPLOAD_STREAMS] = { { "0", 0 }, { "1", 1 } };
+static const Cosm_Feed Feed = { "116164", "key", "test", Streams, UPLOAD_STREAMS };
+static const Upload_Policy Policies[UPLOAD_STREAMS] = { { 2, 3, 30, 240 }, { 10, 15, 30, 240 } };
+
+static unsigned char Add(unsigned long minute, int v0, int v1, unsigned char urgent)
+{
+  int values[UPLOAD_STREAMS];
+
+  values[0] = v0;
+  values[1] = v1;
+  return Upload_Add(Policies, minute, values, urgent);
+}
+
+// sends the queue at 'minute', the clock starts 2013-03-08 00:00; returns the body
+static const char *Send(unsigned long minute, unsigned char synced)
+{
+  Csv_Stamp now = { 2013, 3, 8, 0 };
+  const char *body;
+
+  Csv_Forward(&now, (unsigned int)minute);
+  Usart_Clear();
+  Upload_Send(&Feed, synced ? &now : 0, minute);
+  body = strstr(Usart_Flush(), "\r\n\r\n");
+  CHECK(body != 0);
+  return body ? body + 4 : "";
+}
+
+static void Test_Policy(void)
+{
+  unsigned char i;
+  const char *body;
+
+  CHECK(!Add(5, 20, 215, 0));                // first values, queued, not due yet
+  CHECK(!Add(10, 21, 218, 0));               // inside the deadband
+  CHECK(Add(30, 20, 216, 0));                // the batching window is over
+  CHECK(strcmp(Send(30, 1), "0,2013-03-08T00:05:00Z,20\n1,2013-03-08T00:05:00Z,21.5") == 0);
+
+  CHECK(!Add(35, 20, 216, 0));               // nothing queued, never due
+  CHECK(!Add(55, 22, 217, 0));               // deadband of stream 0, not due yet
+  CHECK(Add(58, 22, 240, 0));                // rate of stream 1, urgent
+  CHECK(strcmp(Send(58, 1), "0,2013-03-08T00:55:00Z,22\n1,2013-03-08T00:58:00Z,24.0") == 0);
+
+  for (i = 13; i < 59; i++)                  // steady until the heartbeat
+    CHECK(!Add(i * 5, 22, 240, 0));
+  CHECK(Add(295, 22, 240, 0));               // 240 min after 00:55
+  CHECK(Add(298, 22, 240, 0));               // 240 min after 00:58
+  CHECK(strcmp(Send(298, 1), "0,2013-03-08T04:55:00Z,22\n1,2013-03-08T04:58:00Z,24.0") == 0);
+
+  CHECK(Add(320, 22, 240, 1));               // urgent, all streams
+  for (i = 0; i < 17; i++)                   // one more than the queue holds
+    CHECK(Add(325 + i, -5 - i, 600 + i, 1));
+  body = Send(345, 1);                       // the oldest two are dropped
+  CHECK(strncmp(body, "0,2013-03-08T05:26:00Z,-6\n1,2013-03-08T05:26:00Z,60.1\n", 54) == 0);
+  CHECK(strstr(body, "0,2013-03-08T05:41:00Z,-21\n1,2013-03-08T05:41:00Z,61.6") != 0);
+
+  CHECK(!Add(372, -19, 616, 0));            // without a clock only the latest
+  CHECK(!Add(374, -17, 616, 0));             // value of each stream, no stamps
+  CHECK(Add(376, -15, 630, 0));
+  CHECK(strcmp(Send(376, 0), "0,-19\n1,63.0") == 0);
+}
+
+static int Current[UPLOAD_STREAMS];          // values of the fixed interval PUT
+
+static void Current_Body(const Cosm_Feed *feed)
+{
+  unsigned char s;
+
+  for (s = 0; s < feed->Count; s++)
+    Cosm_Row(s, 0, Current[s]);
+}
+
+#define DAYS_MAX 400
+
+static int High[DAYS_MAX], Low[DAYS_MAX];    // deg F
+static int Days;
+
+static void Load(void)
+{
+  FILE *f = fopen("../temperatures.csv", "r");
+  char line[80];
+
+  CHECK(f != 0);
+  if (!f)
+    return;
+  fgets(line, sizeof line, f);               // Date,High,Low
+  while (Days < DAYS_MAX && fgets(line, sizeof line, f)
+         && sscanf(line, "%*d,%d,%d", &High[Days], &Low[Days]) == 2)
+    Days++;
+  fclose(f);
+}
+
+static void Test_Year(void)
+{
+  unsigned long start = 1440, minute, puts = 0, bytes = 0, rows = 0, fixed_bytes = 0;
+  double policy_s, fixed_s;
+  const char *body, *p;
+  double f, c;
+  int day, m, v1;
+
+  Load();
+  srand(1);
+  for (day = 0; day < Days; day++)
+    for (m = 0; m < 1440; m += 5)
+    {
+      minute = start + day * 1440UL + m;
+      f = (High[day] + Low[day]) / 2.0
+          + (High[day] - Low[day]) / 2.0 * cos((m / 1440.0 - 15 / 24.0) * 2 * M_PI);
+      c = (f - 32) * 50 / 9;                 // 0.1 deg C
+      v1 = (int)lround(c) + rand() % 3 - 1;
+      Current[0] = (int)lround(c / 10) + 2;
+      Current[1] = v1;
+      Usart_Clear();
+      Cosm_Put(&Feed, Current_Body);
+      Usart_Flush();
+      fixed_bytes += Usart_Length;
+      if (Add(minute, Current[0], v1, v1 >= 600))
+      {
+        body = Send(minute, 1);
+        puts++;
+        rows++;
+        for (p = body; *p; p++)
+          rows += *p == '\n';
+        bytes += Usart_Length;
+      }
+    }
+  policy_s = MODEM_SECONDS(puts, bytes) / Days;
+  fixed_s = MODEM_SECONDS(288.0 * Days, fixed_bytes) / Days;
+  CHECK(Days >= 365);
+  CHECK(puts < Days * 30UL);
+  CHECK(policy_s < fixed_s / 5);
+  Check_Note("upload: %.1f PUTs/day, %lu rows in %d days, %.1f kB/day, modem on %.0f s/day; "
+             "every 300 s: 288 PUTs/day, %lu rows, %.1f kB/day, modem on %.0f s/day\n",
+             puts / (double)Days, rows, Days, bytes / 1024.0 / Days, policy_s,
+             Days * 288UL * 2, fixed_bytes / 1024.0 / Days, fixed_s);
+}
+
+int main(void)
+{
+  Test_Policy();
+  Test_Year();
+  return Check_Done("upload_test");
+}
@@ -0,0 +1,91 @@
+//******************************************************************************
+//  usart.c - USART0 transmitter model for the host tests
+//
+//  Host test, built with gcc
+//******************************************************************************
+
+#include <stdlib.h>
+#include <string.h>
+#include <msp430x14x.h>
+#include "uart_tx.h"
+#include "usart.h"
+#include "check.h"
+
+void usart0_tx(void);
+
+char Usart_Out[8192];
+unsigned int Usart_Length;
+unsigned int Usart_Sleeps;
+
+unsigned char Usart_Run(void)
+{
+  while ((IE1 & UTXIE0) && (IFG1 & UTXIFG0))
+  {
+    IFG1 &= ~UTXIFG0;                        // cleared when serviced
+    TXBUF0 = SIM_TX_IDLE;
+    usart0_tx();
+    if (TXBUF0 != SIM_TX_IDLE)
+    {
+      if (Usart_Length < sizeof Usart_Out - 1)
+        Usart_Out[Usart_Length++] = (char)TXBUF0;
+      Usart_Out[Usart_Length] = 0;
+      IFG1 |= UTXIFG0;                       // TXBUF0 free again
+    }
+    if (Sim_Wake & LPM3_bits)
+    {
+      Sim_Wake = 0;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void Sim_Sleep(unsigned short bits)
+{
+  Sim_SR |= bits & GIE;
+  Usart_Sleeps++;
+  if (Usart_Run())
+    return;
+  Check_Fail(__FILE__, __LINE__, "sleeping with no TX interrupt pending");
+  exit(Check_Done("usart"));
+}
+
+void Usart_Clear(void)
+{
+  Sim_SR |= GIE;
+  Usart_Run();
+  Usart_Length = 0;
+  Usart_Out[0] = 0;
+  Usart_Sleeps = 0;
+}
+
+const char *Usart_Flush(void)
+{
+  UartTx_Flush();
+  Usart_Run();
+  return Usart_Out;
+}
+
+int Usart_Dechunk(const char *s, char *data)
+{
+  unsigned int len, n = 0;
+  char *end;
+
+  for (;;)
+  {
+    len = strtoul(s, &end, 16);
+    if (end == s || end[0] != '\r' || end[1] != '\n')
+      return -1;
+    s = end + 2;
+    if (len > UART_TX_CHUNK_SIZE || strlen(s) < len + 2)
+      return -1;
+    memcpy(data + n, s, len);
+    n += len;
+    s += len;
+    if (s[0] != '\r' || s[1] != '\n')
+      return -1;
+    s += 2;
+    if (len == 0)
+      return *s ? -1 : (int)n;
+  }
+}
@@ -0,0 +1,25 @@
+/*
+usart.h - USART0 transmitter model for the host tests
+
+Models UTXIFG0 as on the F149: set while TXBUF0 is free, cleared when the
+TX interrupt is serviced; a byte written to TXBUF0 moves to the shift
+register at once. Sim_Sleep() runs the TX ISR of uart_tx.c until it wakes
+the producer; if no interrupt is pending the test fails instead of
+hanging like the device would. The bytes sent collect in Usart_Out.
+
+*/
+
+#ifndef _usart_h
+#define _usart_h
+
+extern char Usart_Out[8192];
+extern unsigned int Usart_Length;            // bytes in Usart_Out, 0 terminated
+extern unsigned int Usart_Sleeps;            // producer waits
+
+unsigned char Usart_Run(void);               // pending TX interrupts, 1 = producer woken
+void Usart_Clear(void);                      // lets the ISR go idle, empties Usart_Out
+const char *Usart_Flush(void);               // UartTx_Flush() and idle ISR, returns Usart_Out
+// decodes a chunked body up to its end, returns the data length or -1
+int Usart_Dechunk(const char *s, char *data);
+
+#endif /* _usart_h */
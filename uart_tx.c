@@ -0,0 +1,196 @@
+//******************************************************************************
+//  uart_tx.c - Interrupt driven transmit ring buffer for USART0
+//
+//  sendByte() only stores the byte and enables UTXIE0. The TX ISR fires
+//  once per character (~1ms at 9600 baud) until the buffer is empty, after
+//  that it disables itself again. So the CPU can go back to LPM3 while the
+//  page or the Cosm request is shifted out. Servicing the ISR clears
+//  UTXIFG0, so after the ISR stopped itself TxCommit() sets the flag again
+//  to restart it (TXBUF0 is free at that point).
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include <msp430x14x.h>
+#include <intrinsics.h>
+#include "uart_tx.h"
+
+static unsigned char TxBuffer[UART_TX_BUFFER_SIZE];
+static volatile unsigned char TxHead = 0;    // end of committed data, ISR sends up to here
+static volatile unsigned char TxTail = 0;    // next byte to send, written by ISR
+static volatile unsigned char TxWaiting = 0; // producer sleeps until ISR makes progress
+static unsigned char TxFill = 0;             // next free slot, ahead of TxHead in a chunk
+
+static unsigned char Chunked = 0;            // HTTP chunked transfer encoding active
+static unsigned char Discard = 0;            // drop output
+static unsigned char ChunkStart;             // slot of the chunk size digits
+static unsigned char ChunkLen;               // data bytes in the open chunk
+
+static const char Hex[] = "0123456789ABCDEF";
+
+#define TX_NEXT(i) (((i) + 1) & (UART_TX_BUFFER_SIZE - 1))
+
+// Sleep in LPM3 until 'TxTail' moved on. Interrupts are disabled before the
+// buffer state is checked, _BIS_SR(LPM3_bits + GIE) enables them and goes to
+// sleep in one instruction, so a wake-up from the ISR can not get lost.
+static void TxWait(void)
+{
+  TxWaiting = 1;
+  _BIS_SR(LPM3_bits + GIE);                  // Enter LPM3 w/ interrupt
+  __disable_interrupt();
+}
+
+// Stores a byte behind TxFill, the ISR does not see it before TxCommit()
+static void TxPut(unsigned char byte)
+{
+  __istate_t state = __get_interrupt_state();
+  unsigned char next = TX_NEXT(TxFill);
+
+  __disable_interrupt();
+  while (next == TxTail)                     // buffer full?
+    TxWait();
+  __set_interrupt_state(state);
+
+  TxBuffer[TxFill] = byte;
+  TxFill = next;
+}
+
+static void TxCommit(void)
+{
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();
+  TxHead = TxFill;
+  if (!(IE1 & UTXIE0))                       // ISR idle, its last call cleared UTXIFG0
+    IFG1 |= UTXIFG0;
+  IE1 |= UTXIE0;                             // (re)start TX ISR
+  __set_interrupt_state(state);
+}
+
+// A chunk is "XX\r\n" + data + "\r\n". The two size digits are reserved in
+// the ring and filled in when the chunk is closed, so the data is never
+// copied. The whole chunk is uncommitted until then, that's why it must
+// fit into the ring (UART_TX_CHUNK_SIZE).
+static void TxOpenChunk(void)
+{
+  ChunkStart = TxFill;
+  ChunkLen = 0;
+  TxPut('0');
+  TxPut('0');
+  TxPut('\r');
+  TxPut('\n');
+}
+
+static void TxCloseChunk(void)
+{
+  TxBuffer[ChunkStart] = Hex[ChunkLen >> 4];
+  TxBuffer[TX_NEXT(ChunkStart)] = Hex[ChunkLen & 0x0F];
+  TxPut('\r');
+  TxPut('\n');
+  TxCommit();
+}
+
+/**
+* Puts a single byte into the TX buffer, blocks only if the buffer is full
+**/
+void sendByte(unsigned char byte)
+  {
+  if (Discard)
+    return;
+  TxPut(byte);
+  if (!Chunked)
+    TxCommit();
+  else if (++ChunkLen == UART_TX_CHUNK_SIZE)
+  {
+    TxCloseChunk();
+    TxOpenChunk();
+  }
+  }
+
+void putc(unsigned b)
+  {
+  sendByte(b);
+  }
+
+void printf(const char *s)
+  {
+  char c;
+  
+  // Loops through each character in string 's'
+  while (c = *s++) {
+  sendByte(c);
+  }
+  }
+
+void printfln(const char *s)          //send with \r\n
+  {
+  printf(s);
+  printf("\r\n");
+  }
+
+/**
+* From now on everything sent is framed as HTTP/1.1 chunks
+**/
+void UartTx_BeginChunked(void)
+  {
+  Chunked = 1;
+  TxOpenChunk();
+  }
+
+/**
+* Closes the open chunk and sends the last (empty) chunk
+**/
+void UartTx_EndChunked(void)
+  {
+  if (ChunkLen)
+    TxCloseChunk();
+  else
+    TxFill = ChunkStart;                     // drop unused size field
+  Chunked = 0;
+  printf("0\r\n\r\n");
+  }
+
+/**
+* Drops everything sent from now on (1) or sends again (0)
+**/
+void UartTx_Discard(unsigned char on)
+  {
+  Discard = on;
+  }
+
+/**
+* Waits until the buffer is drained and the last character is shifted out,
+* e.g. before the ME9210 is switched off
+**/
+void UartTx_Flush(void)
+  {
+  __istate_t state = __get_interrupt_state();
+
+  __disable_interrupt();
+  while (TxTail != TxHead)
+    TxWait();
+  __set_interrupt_state(state);
+
+  while (!(UTCTL0 & TXEPT));                 // last character still in shift register
+  }
+
+#pragma vector=USART0TX_VECTOR
+__interrupt void usart0_tx (void)
+{
+  if (TxTail == TxHead)
+  {
+    IE1 &= ~UTXIE0;                          // buffer empty, stop TX ISR
+  }
+  else
+  {
+    TXBUF0 = TxBuffer[TxTail];               // Transmit next character
+    TxTail = TX_NEXT(TxTail);
+  }
+
+  if (TxWaiting)
+  {
+    TxWaiting = 0;
+    _BIC_SR_IRQ(LPM3_bits);                  // wake up waiting producer
+  }
+}
@@ -0,0 +1,33 @@
+/*
+uart_tx.h - Interrupt driven transmit ring buffer for USART0
+
+Producers copy bytes into the ring buffer and return at once, the
+USART0TX_VECTOR ISR feeds TXBUF0 while the CPU stays in LPM3.
+If the buffer is full the producer sleeps until the ISR frees a slot.
+Between UartTx_BeginChunked() and UartTx_EndChunked() all output is sent
+with HTTP/1.1 chunked transfer encoding. UartTx_Discard(1) drops all
+output, e.g. the body of a response to HEAD.
+
+*/
+
+#ifndef _uart_tx_h
+#define _uart_tx_h
+
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 64               // must be a power of 2, max. 128
+#endif
+
+// data bytes per HTTP chunk, size digits and CRLFs must fit into the ring
+#define UART_TX_CHUNK_SIZE (UART_TX_BUFFER_SIZE - 7)
+
+void sendByte(unsigned char byte);
+void putc(unsigned b);
+void printf(const char *s);
+void printfln(const char *s);                // send with \r\n
+void UartTx_Flush(void);                     // wait until last byte has left the USART
+
+void UartTx_BeginChunked(void);              // frame all output as HTTP chunks
+void UartTx_EndChunked(void);                // last chunk, back to plain output
+void UartTx_Discard(unsigned char on);       // 1: drop all output until UartTx_Discard(0)
+
+#endif /* _uart_tx_h */
@@ -0,0 +1,143 @@
+//******************************************************************************
+//  upload.c - Batched Cosm upload of timestamped samples
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "upload.h"
+
+typedef struct
+{
+  unsigned long Minute;                      // time of the sample
+  unsigned char Streams;                     // bit s: Values[s] is reported
+  int Values[UPLOAD_STREAMS];
+} Upload_Sample;
+
+typedef struct
+{
+  unsigned long Minute;                      // of the last queued value
+  int Value;                                 // last queued value
+  int Previous;                              // previous sample
+  unsigned char Known;                       // anything queued yet
+} Upload_State;
+
+static Upload_Sample Queue[UPLOAD_QUEUE];
+static Upload_State State[UPLOAD_STREAMS];
+static unsigned char Head = 0;               // oldest sample
+static unsigned char Count = 0;
+static unsigned long Due = UPLOAD_INTERVAL;  // minute of the next PUT
+static const Csv_Stamp *Now;                 // arguments of Upload_Send() for
+static unsigned long NowMinute;              // the body passes
+
+static unsigned int Upload_Distance(int a, int b)
+{
+  return a > b ? (unsigned int)a - b : (unsigned int)b - a;
+}
+
+// Applies the policy of each stream, returns the streams to report. A rate
+// report sets '*urgent'.
+static unsigned char Upload_Check(const Upload_Policy *policy, unsigned long minute,
+                                  const int *values, unsigned char *urgent)
+{
+  Upload_State *state = State;
+  unsigned char s, streams = 0, report;
+  unsigned long age;
+
+  for (s = 0; s < UPLOAD_STREAMS; s++, state++, policy++)
+  {
+    age = minute - state->Minute;
+    report = *urgent || !state->Known || age >= policy->MaxInterval;
+    if (!report && policy->Rate
+        && Upload_Distance(values[s], state->Previous) >= policy->Rate)
+      report = *urgent = 1;
+    if (!report && age >= policy->MinInterval
+        && Upload_Distance(values[s], state->Value) >= policy->Deadband)
+      report = 1;
+    state->Previous = values[s];
+    if (report)
+    {
+      streams |= 1 << s;
+      state->Minute = minute;
+      state->Value = values[s];
+      state->Known = 1;
+    }
+  }
+  return streams;
+}
+
+unsigned char Upload_Add(const Upload_Policy *policy, unsigned long minute,
+                         const int *values, unsigned char urgent)
+{
+  Upload_Sample *sample;
+  unsigned char streams = Upload_Check(policy, minute, values, &urgent);
+  unsigned char i = Head + Count;
+
+  if (!streams)                              // nothing worth the ME9210
+    return Count && minute >= Due;
+
+  if (i >= UPLOAD_QUEUE)
+    i -= UPLOAD_QUEUE;
+  if (Count == UPLOAD_QUEUE)                 // full, drop the oldest
+  {
+    if (++Head == UPLOAD_QUEUE)
+      Head = 0;
+  }
+  else
+    Count++;
+
+  sample = &Queue[i];
+  sample->Minute = minute;
+  sample->Streams = streams;
+  for (i = 0; i < UPLOAD_STREAMS; i++)
+    sample->Values[i] = values[i];
+
+  return urgent || minute >= Due || Count == UPLOAD_QUEUE;
+}
+
+// one row per reported stream of each queued sample, oldest first; without
+// a clock only the latest value of each stream, Cosm stamps it on arrival
+static void Upload_Body(const Cosm_Feed *feed)
+{
+  const Upload_Sample *sample;
+  Csv_Stamp t;
+  unsigned char i, k, s;
+
+  if (!Now)
+  {
+    for (s = 0; s < feed->Count; s++)
+      for (k = Count; k > 0; k--)            // newest first
+      {
+        i = Head + k - 1;
+        if (i >= UPLOAD_QUEUE)
+          i -= UPLOAD_QUEUE;
+        if (Queue[i].Streams & (1 << s))
+        {
+          Cosm_Row(s, 0, Queue[i].Values[s]);
+          break;
+        }
+      }
+    return;
+  }
+  for (k = 0, i = Head; k < Count; k++)
+  {
+    sample = &Queue[i];
+    t = *Now;
+    Csv_Back(&t, NowMinute - sample->Minute);
+    for (s = 0; s < feed->Count; s++)
+      if (sample->Streams & (1 << s))
+        Cosm_Row(s, &t, sample->Values[s]);
+    if (++i == UPLOAD_QUEUE)
+      i = 0;
+  }
+}
+
+void Upload_Send(const Cosm_Feed *feed, const Csv_Stamp *now, unsigned long minute)
+{
+  Now = now;
+  NowMinute = minute;
+  Cosm_Put(feed, Upload_Body);
+  Head = 0;
+  Count = 0;
+  Due = minute + UPLOAD_INTERVAL;
+}
@@ -0,0 +1,47 @@
+/*
+upload.h - Batched Cosm upload of timestamped samples
+
+Upload_Add() queues one sample set, one value per datastream. Every
+UPLOAD_INTERVAL minutes Upload_Add() reports that the queue is due and
+Upload_Send() puts all queued values into one Cosm v2 CSV PUT, one
+"id,timestamp,value" row per value. So the ME9210 is woken once per
+interval, and the ~200 bytes of request header are sent once for all
+rows. An urgent sample makes the queue due at once.
+
+Each datastream has an Upload_Policy (report by exception): a value is
+only queued when it moved by the deadband since the last queued one,
+changed by the rate since the previous sample, or when the heartbeat
+interval has passed. So with steady readings the queue stays empty and
+the ME9210 is not woken at all. A rate-of-change report is urgent.
+
+*/
+
+#ifndef _upload_h
+#define _upload_h
+
+#include "cosm.h"
+
+#define UPLOAD_STREAMS 2                     // max. datastreams of the feed
+#define UPLOAD_QUEUE   16                    // sample sets
+#ifndef UPLOAD_INTERVAL
+#define UPLOAD_INTERVAL 30                   // minutes between PUTs
+#endif
+
+// limits in the fixed point format of the stream, intervals in minutes
+typedef struct
+{
+  int Deadband;                              // change against the last queued value
+  int Rate;                                  // change against the previous sample, 0 = off
+  unsigned int MinInterval;                  // no deadband report before this
+  unsigned int MaxInterval;                  // heartbeat, queued anyway after this
+} Upload_Policy;
+
+// values in the fixed point format of the stream, one policy per stream;
+// urgent queues all streams. Returns 1 when due.
+unsigned char Upload_Add(const Upload_Policy *policy, unsigned long minute,
+                         const int *values, unsigned char urgent);
+// sends the queue to 'feed', 'now' is the time of 'minute'; now = 0: the
+// clock is not set yet, only the latest value of each stream is sent
+void Upload_Send(const Cosm_Feed *feed, const Csv_Stamp *now, unsigned long minute);
+
+#endif /* _upload_h */
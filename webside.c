@@ -0,0 +1,101 @@
+//******************************************************************************
+//  webside.c - easyWEB demo page as response template
+//
+//  WEBSIDE_PARTS() lists the parts once; the part table and the
+//  Content-Length are both generated from it, so the length can't get out
+//  of step with the texts.
+//
+//  K. Riedel
+//  Built with IAR 5.51.1
+//******************************************************************************
+
+#include "webside.h"
+
+static const char WebSide_Head[] =
+"<html>\r\n"
+"<head>\r\n"
+"<title>easyWEB - dynamic Webside</title>\r\n"
+"</head>\r\n"
+"\r\n"
+"<body bgcolor=\"#F5FFFA\" text=\"#000000\">\r\n"
+"<p><b><font color=\"#000000\" size=\"6\"><i>MSP430 Webserver</i></font></b></p>\r\n"
+"\r\n"
+"<p><b>This is a dynamic website hosted by the embedded Webserver</b> <b>easyWEB.</b></p>\r\n"
+"<p><b>Hardware:</b></p>\r\n"
+"<ul>\r\n"
+"<li><b>MSP430F149, 60KB Flash, 2KB SRAM</b></li>\r\n"
+"<li><b>Embedded DigiConnect Ethernet Module</b></li>\r\n"
+"</ul>\r\n"
+"\r\n"
+"<p><b>A/D Converter Input 0:</b></p>\r\n"
+"\r\n"
+"<table bgcolor=\"#ff0000\" border=\"5\" cellpadding=\"0\" cellspacing=\"0\" width=\"500\">\r\n"
+"<tr>\r\n"
+"<td>\r\n"
+"<table width=\"";
+
+static const char WebSide_Bar1[] =
+"%\" border=\"0\" cellpadding=\"0\" cellspacing=\"0\">\r\n"
+"<tr><td bgcolor=\"#00ff00\">&nbsp;</td></tr>\r\n"
+"</table>\r\n"
+"</td>\r\n"
+"</tr>\r\n"
+"</table>\r\n"
+"\r\n"
+"<table border=\"0\" width=\"540\">\r\n"
+"<tr>\r\n"
+"<td width=\"14%\">0V</td>\r\n"
+"<td width=\"14%\">0.5V</td>\r\n"
+"<td width=\"14%\">1V</td>\r\n"
+"<td width=\"14%\">1.5V</td>\r\n"
+"<td width=\"14%\">2V</td>\r\n"
+"<td width=\"14%\">2.5V</td>\r\n"
+"<td width=\"14%\">3V</td>\r\n"
+"</tr>\r\n"
+"</table>\r\n"
+"\r\n"
+"<p><b>A/D Converter Input 10 (Temperature Diode):</b></p>\r\n"
+"\r\n"
+"<table bgcolor=\"#ff0000\" border=\"5\" cellpadding=\"0\" cellspacing=\"0\" width=\"500\">\r\n"
+"<tr>\r\n"
+"<td>\r\n"
+"<table width=\"";
+
+static const char WebSide_Tail[] =
+"%\" border=\"0\" cellpadding=\"0\" cellspacing=\"0\">\r\n"
+"<tr><td bgcolor=\"#00ff00\">&nbsp;</td></tr> \r\n"
+"</table>\r\n"
+"</td>\r\n"
+"</tr>\r\n"
+"</table>\r\n"
+"\r\n"
+"<table border=\"0\" width=\"540\">\r\n"
+"<tr>\r\n"
+"<td width=\"12%\">0V</td>\r\n"
+"<td width=\"12%\">0.25V</td>\r\n"
+"<td width=\"12%\">0.5V</td>\r\n"
+"<td width=\"12%\">0.75V</td>\r\n"
+"<td width=\"12%\">1V</td>\r\n"
+"<td width=\"12%\">1.25V</td>\r\n"
+"<td width=\"12%\">1.5V</td>\r\n"
+"</tr>\r\n"
+"</table>\r\n"
+"</body>\r\n"
+"</html>\r\n"
+"\r\n";
+
+#define WEBSIDE_PARTS(PART) \
+  PART(WebSide_Head, SLOT_UNSIGNED, 3) \
+  PART(WebSide_Bar1, SLOT_UNSIGNED, 3) \
+  PART(WebSide_Tail, SLOT_NONE,     0)
+
+static const Template_Part WebSide_Parts[] = {
+  WEBSIDE_PARTS(TEMPLATE_PART)
+};
+
+const Template WebSide = {
+  "text/html",
+  0 WEBSIDE_PARTS(TEMPLATE_LENGTH),
+  WebSide_Parts,
+  sizeof WebSide_Parts / sizeof WebSide_Parts[0]
+};